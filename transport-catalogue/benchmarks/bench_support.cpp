@@ -0,0 +1,166 @@
+#include "bench_support.h"
+
+#include "tools/random.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+
+using namespace std;
+
+namespace {
+    atomic<uint64_t> allocation_count{ 0 };
+
+    // Поле из /proc/self/status в мегабайтах (ядро пишет килобайты); 0, если его нет
+    double ReadStatusMegabytes(string_view field) {
+        ifstream status("/proc/self/status");
+        for (string line; getline(status, line);) {
+            if (line.size() > field.size() && line.compare(0, field.size(), field) == 0 && line[field.size()] == ':') {
+                return strtod(line.c_str() + field.size() + 1, nullptr) / 1024.0;
+            }
+        }
+        return 0.0;
+    }
+
+    // Сбрасывает пик резидентной памяти процесса (VmHWM) до текущего значения
+    bool ResetPeakRss() {
+        ofstream clear_refs("/proc/self/clear_refs");
+        clear_refs << "5";
+        clear_refs.close();
+        return static_cast<bool>(clear_refs);
+    }
+}
+
+// Замена глобальных operator new считает выделения во всём бенчмарке
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, memory_order_relaxed);
+    if (void* ptr = malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+namespace bench {
+
+    NetworkSize GetNetworkSize(const benchmark::State& state) {
+        return { static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1)),
+                 static_cast<size_t>(state.range(2)) };
+    }
+
+    void NetworkSizes(benchmark::internal::Benchmark* benchmark, size_t max_stops) {
+        benchmark->ArgNames({ "stops", "buses", "per_bus" });
+        const NetworkSize sizes[] = {
+            { 100, 10, 10 },
+            { 1'000, 100, 20 },
+            { 10'000, 1'000, 30 },
+            { 100'000, 5'000, 50 },
+        };
+        for (const NetworkSize& size : sizes) {
+            if (size.stops <= max_stops) {
+                benchmark->Args({ static_cast<int64_t>(size.stops), static_cast<int64_t>(size.buses),
+                                  static_cast<int64_t>(size.stops_per_bus) });
+            }
+        }
+    }
+
+    void FillCatalogue(transport::core::TransportCatalogue& catalogue, const NetworkSize& size, uint64_t seed) {
+        tools::Random random(seed);
+        for (size_t i = 0; i < size.stops; ++i) {
+            const double lat = random.Uniform(55.5, 55.9);
+            const double lng = random.Uniform(37.3, 37.9);
+            catalogue.AddStop("Stop "s + to_string(i), { lat, lng });
+        }
+
+        auto distance = [&random] {
+            return 100 + static_cast<int>(random.Index(4901));
+        };
+        for (size_t i = 0; i < size.buses; ++i) {
+            vector<uint32_t> stops;
+            for (size_t j = 0; j < size.stops_per_bus; ++j) {
+                stops.push_back(static_cast<uint32_t>(random.Index(size.stops)));
+            }
+            for (size_t j = 1; j < stops.size(); ++j) {
+                catalogue.AddDistance(&catalogue.GetStop(stops[j - 1]), &catalogue.GetStop(stops[j]), distance());
+            }
+            const uint32_t last_stop = stops.back();
+            if (i % 2 == 0) {
+                stops.push_back(stops.front());
+                catalogue.AddDistance(&catalogue.GetStop(last_stop), &catalogue.GetStop(stops.front()), distance());
+            }
+            else {
+                stops.insert(stops.end(), next(stops.rbegin()), stops.rend());
+            }
+            catalogue.AddRoute("Bus "s + to_string(i), move(stops), last_stop);
+        }
+        catalogue.Finalize();
+    }
+
+    vector<pair<size_t, size_t>> MakeStopPairs(size_t stop_count, size_t pair_count, uint64_t seed) {
+        tools::Random random(seed);
+        vector<pair<size_t, size_t>> pairs;
+        pairs.reserve(pair_count);
+        for (size_t i = 0; i < pair_count; ++i) {
+            const size_t from = random.Index(stop_count);
+            pairs.emplace_back(from, random.Index(stop_count));
+        }
+        return pairs;
+    }
+
+    RenderSettings MakeRenderSettings() {
+        RenderSettings settings;
+        settings.width = 1200;
+        settings.height = 1200;
+        settings.padding = 50;
+        settings.line_width = 14;
+        settings.stop_radius = 5;
+        settings.bus_label_font_size = 20;
+        settings.bus_label_offset = { 7, 15 };
+        settings.stop_label_font_size = 20;
+        settings.stop_label_offset = { 7, -3 };
+        settings.underlayer_color = svg::Rgba(255, 255, 255, 0.85);
+        settings.underlayer_width = 3;
+        settings.color_palette = { "green"s, svg::Rgb(255, 160, 0), "red"s };
+        return settings;
+    }
+
+    RoutingSettings MakeRoutingSettings(graph::SearchMode mode) {
+        return { 6, 40, mode };
+    }
+
+    MemoryProbe::MemoryProbe()
+        : allocations_(allocation_count.load(memory_order_relaxed))
+        , rss_mb_(ReadStatusMegabytes("VmRSS"sv))
+        , peak_reset_(ResetPeakRss()) {
+    }
+
+    void MemoryProbe::Report(benchmark::State& state) const {
+        state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocation_count.load(memory_order_relaxed) - allocations_),
+                                                      benchmark::Counter::kAvgIterations);
+        const double peak_mb = ReadStatusMegabytes(peak_reset_ ? "VmHWM"sv : "VmRSS"sv);
+        state.counters["peak_rss_delta_mb"] = max(0.0, peak_mb - rss_mb_);
+    }
+
+}  // namespace bench
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "map_renderer.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+    // Размер сети берётся из аргументов бенчмарка: {остановки, автобусы, остановок в автобусе}
+    struct NetworkSize {
+        size_t stops = 0;
+        size_t buses = 0;
+        size_t stops_per_bus = 0;
+    };
+
+    NetworkSize GetNetworkSize(const benchmark::State& state);
+
+    // Регистрирует набор размеров сети от малого до крупного; max_stops отсекает
+    // размеры, на которых бенчмарк работал бы слишком долго
+    void NetworkSizes(benchmark::internal::Benchmark* benchmark, size_t max_stops);
+
+    // Случайная, но одинаковая при каждом запуске сеть: остановки в границах города,
+    // расстояния между соседними остановками маршрутов, половина маршрутов кольцевые
+    void FillCatalogue(transport::core::TransportCatalogue& catalogue, const NetworkSize& size, uint64_t seed = 42);
+
+    // Пары индексов остановок для запросов, тоже детерминированные
+    std::vector<std::pair<size_t, size_t>> MakeStopPairs(size_t stop_count, size_t pair_count, uint64_t seed = 7);
+
+    RenderSettings MakeRenderSettings();
+    RoutingSettings MakeRoutingSettings(graph::SearchMode mode = graph::SearchMode::DIJKSTRA);
+
+    // Замер памяти одного случая бенчмарка: создаётся после подготовки данных, перед циклом.
+    // Report добавляет счётчики allocs (вызовов operator new на итерацию) и peak_rss_delta_mb —
+    // на сколько пик резидентной памяти за случай превысил её размер при создании замера.
+    // Пик процесса сбрасывается через /proc/self/clear_refs, поэтому предыдущие, более
+    // крупные случаи не заслоняют этот; где сброс недоступен, берётся прирост текущей памяти
+    class MemoryProbe {
+    public:
+        MemoryProbe();
+        void Report(benchmark::State& state) const;
+
+    private:
+        uint64_t allocations_;
+        double rss_mb_;
+        bool peak_reset_;
+    };
+
+}  // namespace bench
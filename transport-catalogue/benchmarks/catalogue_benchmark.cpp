@@ -0,0 +1,97 @@
+// Горячие пути каталога: геодезические расстояния и таблица дорожных расстояний
+#include "bench_support.h"
+
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+    // Расстояния вдоль всех маршрутов по одному отрезку за вызов geo::ComputeDistance
+    void BM_ComputeDistance(benchmark::State& state) {
+        transport::core::TransportCatalogue catalogue;
+        bench::FillCatalogue(catalogue, bench::GetNetworkSize(state));
+        vector<pair<geo::Coordinates, geo::Coordinates>> segments;
+        for (const Route& route : catalogue.GetAllBuses()) {
+            for (size_t i = 1; i < route.stops.size(); ++i) {
+                segments.emplace_back(catalogue.GetStop(route.stops[i - 1]).coordinates,
+                                      catalogue.GetStop(route.stops[i]).coordinates);
+            }
+        }
+
+        const bench::MemoryProbe memory;
+        for (auto _ : state) {
+            double total = 0;
+            for (const auto& [from, to] : segments) {
+                total += geo::ComputeDistance(from, to);
+            }
+            benchmark::DoNotOptimize(total);
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(segments.size()));
+        memory.Report(state);
+    }
+    BENCHMARK(BM_ComputeDistance)->Apply([](benchmark::internal::Benchmark* benchmark) {
+        bench::NetworkSizes(benchmark, 100'000);
+    });
+
+    // Те же расстояния пакетом geo::ComputeDistances по предподготовленным координатам
+    void BM_ComputeDistances(benchmark::State& state) {
+        transport::core::TransportCatalogue catalogue;
+        bench::FillCatalogue(catalogue, bench::GetNetworkSize(state));
+        vector<vector<geo::PreparedCoordinates>> routes;
+        size_t segment_count = 0;
+        for (const Route& route : catalogue.GetAllBuses()) {
+            auto& points = routes.emplace_back();
+            for (uint32_t stop : route.stops) {
+                points.push_back(catalogue.GetStop(stop).prepared);
+            }
+            segment_count += points.size() - 1;
+        }
+        vector<double> distances;
+
+        const bench::MemoryProbe memory;
+        for (auto _ : state) {
+            double total = 0;
+            for (const auto& points : routes) {
+                distances.resize(points.size() - 1);
+                geo::ComputeDistances(points.data(), points.size(), distances.data());
+                total += distances.front();
+            }
+            benchmark::DoNotOptimize(total);
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(segment_count));
+        memory.Report(state);
+    }
+    BENCHMARK(BM_ComputeDistances)->Apply([](benchmark::internal::Benchmark* benchmark) {
+        bench::NetworkSizes(benchmark, 100'000);
+    });
+
+    // Поиск дорожного расстояния по индексам остановок: прямые, обратные и отсутствующие пары
+    void BM_FindDistance(benchmark::State& state) {
+        transport::core::TransportCatalogue catalogue;
+        bench::FillCatalogue(catalogue, bench::GetNetworkSize(state));
+        vector<pair<size_t, size_t>> pairs;
+        for (const Route& route : catalogue.GetAllBuses()) {
+            for (size_t i = 1; i < route.stops.size(); ++i) {
+                pairs.emplace_back(route.stops[i - 1], route.stops[i]);
+            }
+        }
+        const auto random_pairs = bench::MakeStopPairs(catalogue.GetStopsCount(), pairs.size() / 4 + 1);
+        pairs.insert(pairs.end(), random_pairs.begin(), random_pairs.end());
+
+        const bench::MemoryProbe memory;
+        for (auto _ : state) {
+            int64_t total = 0;
+            for (const auto& [from, to] : pairs) {
+                total += catalogue.FindDistance(from, to);
+            }
+            benchmark::DoNotOptimize(total);
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(pairs.size()));
+        memory.Report(state);
+    }
+    BENCHMARK(BM_FindDistance)->Apply([](benchmark::internal::Benchmark* benchmark) {
+        bench::NetworkSizes(benchmark, 100'000);
+    });
+
+}  // namespace
@@ -0,0 +1,63 @@
+// Сравнение geo::ComputeDistance и пакетного geo::ComputeDistances на предподготовленных координатах.
+// Сборка: cmake --build <каталог сборки> --target geo_benchmark (запускается и целью bench)
+#include "geo.h"
+#include "tools/random.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+int main() {
+    const size_t count = 1'000'000;
+    const int repeats = 10;
+
+    tools::Random random(42);
+    vector<geo::Coordinates> points(count);
+    for (auto& point : points) {
+        const double lat = random.Uniform(55.5, 55.9);
+        point = { lat, random.Uniform(37.3, 37.9) };
+    }
+    vector<geo::PreparedCoordinates> prepared;
+    prepared.reserve(count);
+    for (const auto& point : points) {
+        prepared.push_back(geo::Prepare(point));
+    }
+
+    vector<double> expected(count - 1);
+    vector<double> actual(count - 1);
+    double checksum = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (size_t i = 0; i + 1 < count; ++i) {
+            expected[i] = geo::ComputeDistance(points[i], points[i + 1]);
+        }
+        checksum += expected[r];
+    }
+    const auto plain = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        geo::ComputeDistances(prepared.data(), prepared.size(), actual.data());
+        checksum += actual[r];
+    }
+    const auto batch = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+    double max_relative_error = 0;
+    for (size_t i = 0; i + 1 < count; ++i) {
+        if (expected[i] != 0) {
+            max_relative_error = max(max_relative_error, abs(actual[i] - expected[i]) / expected[i]);
+        }
+    }
+
+    const double segments = static_cast<double>((count - 1) * repeats);
+    cout << "ComputeDistance:  " << plain / segments << " ns/segment" << endl;
+    cout << "ComputeDistances: " << batch / segments << " ns/segment" << endl;
+    cout << "max relative error: " << max_relative_error << endl;
+    cout << "checksum: " << checksum << endl;
+    return max_relative_error <= 1e-9 ? 0 : 1;
+}
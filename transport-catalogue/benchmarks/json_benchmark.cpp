@@ -0,0 +1,84 @@
+// Разбор и печать JSON размером с base_requests сети
+#include "bench_support.h"
+#include "json.h"
+#include "json_builder.h"
+
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+    // base_requests в том виде, в каком их присылают на вход: остановки с расстояниями и автобусы
+    json::Document MakeBaseRequests(const bench::NetworkSize& size) {
+        transport::core::TransportCatalogue catalogue;
+        bench::FillCatalogue(catalogue, size);
+        json::Builder builder;
+        auto requests = builder.StartDict().Key("base_requests"s).StartArray();
+        for (const Stop& stop : catalogue.GetAllStops()) {
+            requests.StartDict()
+                .Key("type"s).Value("Stop"s)
+                .Key("name"s).Value(stop.name)
+                .Key("latitude"s).Value(stop.coordinates.lat)
+                .Key("longitude"s).Value(stop.coordinates.lng)
+                .Key("road_distances"s).StartDict();
+            catalogue.ForEachDistance(stop.idx, [&](size_t to, int distance) {
+                builder.Key(catalogue.GetStop(to).name).Value(distance);
+            });
+            builder.EndDict().EndDict();
+        }
+        for (const Route& route : catalogue.GetAllBuses()) {
+            auto stops = builder.StartDict()
+                .Key("type"s).Value("Bus"s)
+                .Key("name"s).Value(route.name)
+                .Key("is_roundtrip"s).Value(true)
+                .Key("stops"s).StartArray();
+            for (uint32_t stop : route.stops) {
+                stops.Value(catalogue.GetStop(stop).name);
+            }
+            builder.EndArray().EndDict();
+        }
+        builder.EndArray().EndDict();
+        return json::Document(builder.Build());
+    }
+
+    string PrintDocument(const json::Document& document) {
+        ostringstream output;
+        json::Print(document, output);
+        return output.str();
+    }
+
+    void BM_JsonLoad(benchmark::State& state) {
+        const string text = PrintDocument(MakeBaseRequests(bench::GetNetworkSize(state)));
+
+        const bench::MemoryProbe memory;
+        for (auto _ : state) {
+            json::Document document = json::Load(string_view(text));
+            benchmark::DoNotOptimize(document);
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+        memory.Report(state);
+    }
+    BENCHMARK(BM_JsonLoad)->Apply([](benchmark::internal::Benchmark* benchmark) {
+        bench::NetworkSizes(benchmark, 100'000);
+    })->Unit(benchmark::kMillisecond);
+
+    void BM_JsonPrint(benchmark::State& state) {
+        const json::Document document = MakeBaseRequests(bench::GetNetworkSize(state));
+
+        size_t printed = 0;
+        const bench::MemoryProbe memory;
+        for (auto _ : state) {
+            ostringstream output;
+            json::Print(document, output);
+            printed = static_cast<size_t>(output.tellp());
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(printed));
+        memory.Report(state);
+    }
+    BENCHMARK(BM_JsonPrint)->Apply([](benchmark::internal::Benchmark* benchmark) {
+        bench::NetworkSizes(benchmark, 100'000);
+    })->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,29 @@
+// Отрисовка карты: MapRenderer рисует SVG целиком в конструкторе
+#include "bench_support.h"
+
+using namespace std;
+
+namespace {
+
+    void BM_RenderMap(benchmark::State& state) {
+        transport::core::TransportCatalogue catalogue;
+        bench::FillCatalogue(catalogue, bench::GetNetworkSize(state));
+        const RenderSettings settings = bench::MakeRenderSettings();
+        const auto routes = catalogue.GetSortedRoutes();
+        const auto stops = catalogue.GetSortedStops();
+
+        size_t map_size = 0;
+        const bench::MemoryProbe memory;
+        for (auto _ : state) {
+            // Копии отсортированных маршрутов и остановок входят в замер так же, как в MapCache
+            const MapRenderer renderer(settings, routes, stops);
+            map_size = renderer.GetMap().size();
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(map_size));
+        memory.Report(state);
+    }
+    BENCHMARK(BM_RenderMap)->Apply([](benchmark::internal::Benchmark* benchmark) {
+        bench::NetworkSizes(benchmark, 100'000);
+    })->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,64 @@
+// Построение графа маршрутизатора и поиск маршрутов в каждом режиме
+#include "bench_support.h"
+
+using namespace std;
+
+namespace {
+
+    // Конструктор Transport_router: InitGraph и подготовка Router в режиме Дейкстры
+    void BM_InitGraph(benchmark::State& state) {
+        transport::core::TransportCatalogue catalogue;
+        bench::FillCatalogue(catalogue, bench::GetNetworkSize(state));
+        const RoutingSettings settings = bench::MakeRoutingSettings();
+        const size_t thread_count = static_cast<size_t>(state.range(3));
+
+        size_t edge_count = 0;
+        const bench::MemoryProbe memory;
+        for (auto _ : state) {
+            Transport_router router(catalogue, settings, thread_count);
+            edge_count = router.GetGraph().GetEdgeCount();
+            benchmark::DoNotOptimize(edge_count);
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(edge_count));
+        state.counters["edges"] = static_cast<double>(edge_count);
+        memory.Report(state);
+    }
+    BENCHMARK(BM_InitGraph)->Apply([](benchmark::internal::Benchmark* benchmark) {
+        benchmark->ArgNames({ "stops", "buses", "per_bus", "threads" });
+        for (int64_t threads : { 1, 4 }) {
+            benchmark->Args({ 1'000, 100, 20, threads });
+            benchmark->Args({ 10'000, 1'000, 30, threads });
+        }
+    })->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // graph::Router::BuildRoute на случайных парах остановок; подготовка индекса не измеряется
+    template <graph::SearchMode Mode>
+    void BM_BuildRoute(benchmark::State& state) {
+        transport::core::TransportCatalogue catalogue;
+        bench::FillCatalogue(catalogue, bench::GetNetworkSize(state));
+        const RoutingSettings settings = bench::MakeRoutingSettings(Mode);
+        const Transport_router transport_router(catalogue, settings);
+        const graph::Router<RouteWeight>& router = transport_router.GetRouter();
+        const auto pairs = bench::MakeStopPairs(catalogue.GetStopsCount(), 256);
+
+        size_t found = 0;
+        size_t next_pair = 0;
+        const bench::MemoryProbe memory;
+        for (auto _ : state) {
+            const auto& [from, to] = pairs[next_pair++ % pairs.size()];
+            const auto route = router.BuildRoute(from, to);
+            found += route.has_value();
+            benchmark::DoNotOptimize(route);
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.counters["found"] = benchmark::Counter(static_cast<double>(found), benchmark::Counter::kAvgIterations);
+        memory.Report(state);
+    }
+    BENCHMARK_TEMPLATE(BM_BuildRoute, graph::SearchMode::DIJKSTRA)->Apply([](benchmark::internal::Benchmark* benchmark) {
+        bench::NetworkSizes(benchmark, 10'000);
+    })->Unit(benchmark::kMicrosecond);
+    BENCHMARK_TEMPLATE(BM_BuildRoute, graph::SearchMode::BIDIRECTIONAL)->Apply([](benchmark::internal::Benchmark* benchmark) {
+        bench::NetworkSizes(benchmark, 10'000);
+    })->Unit(benchmark::kMicrosecond);
+
+}  // namespace
@@ -1,14 +1,18 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 #include "geo.h"
 struct Route {
     std::string name;
-    std::vector<std::string> stops;
-    std::string last_stop;
+    // Индексы остановок (Stop::idx); имена хранятся только в каталоге
+    std::vector<uint32_t> stops;
+    uint32_t last_stop = 0;
+    size_t idx = 0;
 };
 struct Stop {
     std::string name;
     geo::Coordinates coordinates;
     size_t idx = 0;
+    geo::PreparedCoordinates prepared = geo::Prepare(coordinates);
 };
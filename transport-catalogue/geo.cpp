@@ -5,6 +5,15 @@
 
 namespace geo {
 
+namespace {
+    const double DR = M_PI / 180.0;
+    const double EARTH_RADIUS = 6371000;
+}
+
+PreparedCoordinates Prepare(Coordinates coordinates) {
+    return { coordinates, std::sin(coordinates.lat * DR), std::cos(coordinates.lat * DR) };
+}
+
 double ComputeDistance(Coordinates from, Coordinates to) {
     using namespace std;
     if (from == to) {
@@ -16,4 +25,20 @@ double ComputeDistance(Coordinates from, Coordinates to) {
         * 6371000;
 }
 
-}  // namespace geo
\ No newline at end of file
+double ComputeDistance(const PreparedCoordinates& from, const PreparedCoordinates& to) {
+    using namespace std;
+    if (from.coordinates == to.coordinates) {
+        return 0;
+    }
+    return acos(from.sin_lat * to.sin_lat
+                + from.cos_lat * to.cos_lat * cos(abs(from.coordinates.lng - to.coordinates.lng) * DR))
+        * EARTH_RADIUS;
+}
+
+void ComputeDistances(const PreparedCoordinates* points, size_t count, double* out) {
+    for (size_t i = 0; i + 1 < count; ++i) {
+        out[i] = ComputeDistance(points[i], points[i + 1]);
+    }
+}
+
+}  // namespace geo
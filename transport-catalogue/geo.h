@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
 
 namespace geo {
     struct Coordinates {
@@ -13,5 +14,22 @@ namespace geo {
             return !(*this == other);
         }
     };
+
+    // Координаты с заранее посчитанными синусом и косинусом широты.
+    // Долгота остаётся в градусах, чтобы результат совпадал с ComputeDistance побитово
+    struct PreparedCoordinates {
+        Coordinates coordinates;
+        double sin_lat = 0.0;
+        double cos_lat = 0.0;
+    };
+
+    PreparedCoordinates Prepare(Coordinates coordinates);
+
     double ComputeDistance(Coordinates from, Coordinates to);
+    double ComputeDistance(const PreparedCoordinates& from, const PreparedCoordinates& to);
+
+    // Записывает в out[i] расстояние между points[i] и points[i + 1], всего count - 1 значений.
+    // Это обычный скалярный цикл: cos и acos из libm компилятор не векторизует,
+    // а выигрыш даёт только то, что синус и косинус широты уже посчитаны
+    void ComputeDistances(const PreparedCoordinates* points, size_t count, double* out);
 }
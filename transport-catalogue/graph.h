@@ -2,7 +2,10 @@
 
 #include "ranges.h"
 
+#include <algorithm>
 #include <cstdlib>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace graph {
@@ -21,54 +24,174 @@ template <typename Weight>
 class DirectedWeightedGraph {
 private:
     using IncidenceList = std::vector<EdgeId>;
-    using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+    using IncidentEdgesRange = ranges::Range<const EdgeId*>;
 
 public:
     DirectedWeightedGraph() = default;
     explicit DirectedWeightedGraph(size_t vertex_count);
+    // Строит сразу замороженный граф из готового списка рёбер: id ребра — его индекс в edges
+    DirectedWeightedGraph(size_t vertex_count, std::vector<Edge<Weight>> edges);
     EdgeId AddEdge(const Edge<Weight>& edge);
 
+    // Переводит граф в компактное представление CSR: концы и веса рёбер лежат отдельными
+    // массивами в порядке начала, так что исходящие из вершины рёбра идут подряд, а id рёбер
+    // сохраняются через таблицу позиций. Начало ребра задаётся самим отрезком CSR
+    // и отдельно не хранится. После этого AddEdge недоступен
+    void Freeze();
+    bool IsFrozen() const;
+
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
-    const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+    // У замороженного графа ребро собирается из массивов CSR, начало ищется по offsets_
+    Edge<Weight> GetEdge(EdgeId edge_id) const;
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
+    // Вызывает callback(edge_id, to, weight) для каждого ребра, исходящего из vertex.
+    // У замороженного графа обход идёт по непрерывной памяти
+    template <typename Callback>
+    void ForEachIncidentEdge(VertexId vertex, Callback&& callback) const;
+
 private:
+    size_t vertex_count_ = 0;
+    // До заморозки: рёбра в порядке id и списки инцидентности
     std::vector<Edge<Weight>> edges_;
     std::vector<IncidenceList> incidence_lists_;
+
+    // После заморозки: концы и веса рёбер в порядке CSR
+    bool frozen_ = false;
+    std::vector<size_t> offsets_;
+    std::vector<VertexId> targets_;
+    std::vector<Weight> weights_;
+    // Позиция CSR -> id ребра и id ребра -> позиция CSR
+    std::vector<EdgeId> incident_ids_;
+    std::vector<size_t> edge_positions_;
+
+    void CheckEdge(const Edge<Weight>& edge) const;
+    // Раскладывает рёбра из edges_ (в порядке id) по позициям CSR и освобождает edges_
+    void BuildIncidence();
 };
 
 template <typename Weight>
 DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-    : incidence_lists_(vertex_count) {
+    : vertex_count_(vertex_count)
+    , incidence_lists_(vertex_count) {
+}
+
+template <typename Weight>
+DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count, std::vector<Edge<Weight>> edges)
+    : vertex_count_(vertex_count)
+    , edges_(std::move(edges)) {
+    for (const Edge<Weight>& edge : edges_) {
+        CheckEdge(edge);
+    }
+    BuildIncidence();
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::CheckEdge(const Edge<Weight>& edge) const {
+    if (edge.from >= vertex_count_ || edge.to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+}
+
+// Сортировка подсчётом по началу ребра; внутри вершины рёбра идут по возрастанию id
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::BuildIncidence() {
+    offsets_.assign(vertex_count_ + 1, 0);
+    for (const Edge<Weight>& edge : edges_) {
+        ++offsets_[edge.from + 1];
+    }
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        offsets_[vertex + 1] += offsets_[vertex];
+    }
+    incident_ids_.resize(edges_.size());
+    edge_positions_.resize(edges_.size());
+    targets_.resize(edges_.size());
+    weights_.resize(edges_.size());
+    std::vector<size_t> positions(offsets_.begin(), offsets_.end() - 1);
+    for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+        const Edge<Weight>& edge = edges_[edge_id];
+        const size_t position = positions[edge.from]++;
+        incident_ids_[position] = edge_id;
+        edge_positions_[edge_id] = position;
+        targets_[position] = edge.to;
+        weights_[position] = edge.weight;
+    }
+    edges_ = {};
+    incidence_lists_ = {};
+    frozen_ = true;
 }
 
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+    if (frozen_) {
+        throw std::logic_error("Can't add an edge to a frozen graph");
+    }
+    CheckEdge(edge);
+    incidence_lists_[edge.from].push_back(edges_.size());
     edges_.push_back(edge);
-    const EdgeId id = edges_.size() - 1;
-    incidence_lists_.at(edge.from).push_back(id);
-    return id;
+    return edges_.size() - 1;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Freeze() {
+    if (frozen_) {
+        return;
+    }
+    BuildIncidence();
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return frozen_;
 }
 
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-    return incidence_lists_.size();
+    return vertex_count_;
 }
 
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetEdgeCount() const {
-    return edges_.size();
+    return frozen_ ? targets_.size() : edges_.size();
 }
 
 template <typename Weight>
-const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
-    return edges_.at(edge_id);
+Edge<Weight> DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
+    if (!frozen_) {
+        return edges_.at(edge_id);
+    }
+    const size_t position = edge_positions_.at(edge_id);
+    // Последняя вершина, чей отрезок CSR начинается не позже position
+    const VertexId from = std::upper_bound(offsets_.begin(), offsets_.end(), position) - offsets_.begin() - 1;
+    return {from, targets_[position], weights_[position]};
 }
 
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-    return ranges::AsRange(incidence_lists_.at(vertex));
+    if (vertex >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (frozen_) {
+        return {incident_ids_.data() + offsets_[vertex], incident_ids_.data() + offsets_[vertex + 1]};
+    }
+    const IncidenceList& incidence_list = incidence_lists_[vertex];
+    return {incidence_list.data(), incidence_list.data() + incidence_list.size()};
+}
+
+template <typename Weight>
+template <typename Callback>
+void DirectedWeightedGraph<Weight>::ForEachIncidentEdge(VertexId vertex, Callback&& callback) const {
+    if (frozen_) {
+        for (size_t i = offsets_[vertex]; i < offsets_[vertex + 1]; ++i) {
+            callback(incident_ids_[i], targets_[i], weights_[i]);
+        }
+        return;
+    }
+    for (const EdgeId edge_id : incidence_lists_[vertex]) {
+        const Edge<Weight>& edge = edges_[edge_id];
+        callback(edge_id, edge.to, edge.weight);
+    }
 }
 }  // namespace graph
\ No newline at end of file
@@ -1,239 +1,300 @@
 #include "json.h"
+#include "json_scan.h"
+#include "trace.h"
 #include <algorithm>
+#include <charconv>
+#include <istream>
 using namespace std;
 
 namespace json {
 
-    namespace {
+    // Размер куска при чтении потока неизвестной длины
+    const size_t READ_CHUNK_SIZE = 1 << 16;
 
-        Node LoadNode(istream& input);
+    namespace detail {
 
-        Node LoadArray(istream& input) {
-            Array result;
-            for (char c; input >> c && c != ']';) {
-                if (c != ',') {
-                    input.putback(c);
+        void ScanString(const char*& pos, const char* end, std::string& s) {
+            while (true) {
+                const char* special = FindStringSpecial(pos, end);
+                s.append(pos, special);
+                pos = special;
+                if (pos == end) {
+                    // Поток закончился до того, как встретили закрывающую кавычку?
+                    throw ParsingError("String parsing error");
+                }
+                const char ch = *pos++;
+                if (ch == '"') {
+                    // Встретили закрывающую кавычку
+                    break;
+                }
+                if (ch == '\n' || ch == '\r') {
+                    // Строковый литерал внутри- JSON не может прерываться символами \r или \n
+                    throw ParsingError("Unexpected end of line"s);
+                }
+                // Встретили начало escape-последовательности
+                if (pos == end) {
+                    // Поток завершился сразу после символа обратной косой черты
+                    throw ParsingError("String parsing error");
+                }
+                const char escaped_char = *pos++;
+                // Обрабатываем одну из последовательностей: \\, \n, \t, \r, \"
+                switch (escaped_char) {
+                case 'n':
+                    s.push_back('\n');
+                    break;
+                case 't':
+                    s.push_back('\t');
+                    break;
+                case 'r':
+                    s.push_back('\r');
+                    break;
+                case '"':
+                    s.push_back('"');
+                    break;
+                case '\\':
+                    s.push_back('\\');
+                    break;
+                default:
+                    // Встретили неизвестную escape-последовательность
+                    throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
                 }
-                result.push_back(LoadNode(input));
-            }
-            if (!input) {
-                throw ParsingError("");
             }
-            return Node(move(result));
         }
 
-        Node LoadNumber(std::istream& input) {
-            using namespace std::literals;
+        NumberToken ScanNumber(const char*& pos, const char* end) {
+            const char* start = pos;
 
-            std::string parsed_num;
-
-            // Считывает в parsed_num очередной символ из input
-            auto read_char = [&parsed_num, &input] {
-                parsed_num += static_cast<char>(input.get());
-                if (!input) {
-                    throw ParsingError("Failed to read number from stream"s);
-                }
-                };
-
-            // Считывает одну или более цифр в parsed_num из input
-            auto read_digits = [&input, read_char] {
-                if (!std::isdigit(input.peek())) {
+            // Считывает одну или более цифр
+            auto read_digits = [&pos, end] {
+                if (pos == end || !IsDigit(*pos)) {
                     throw ParsingError("A digit is expected"s);
                 }
-                while (std::isdigit(input.peek())) {
-                    read_char();
+                while (pos != end && IsDigit(*pos)) {
+                    ++pos;
                 }
-                };
+            };
+            auto peek = [&pos, end] {
+                return pos == end ? '\0' : *pos;
+            };
 
-            if (input.peek() == '-') {
-                read_char();
+            if (peek() == '-') {
+                ++pos;
             }
             // Парсим целую часть числа
-            if (input.peek() == '0') {
-                read_char();
+            if (peek() == '0') {
+                ++pos;
                 // После 0 в JSON не могут идти другие цифры
             }
             else {
                 read_digits();
             }
 
-            bool is_int = true;
+            NumberToken number;
             // Парсим дробную часть числа
-            if (input.peek() == '.') {
-                read_char();
+            if (peek() == '.') {
+                ++pos;
                 read_digits();
-                is_int = false;
+                number.is_int = false;
             }
 
             // Парсим экспоненциальную часть числа
-            if (int ch = input.peek(); ch == 'e' || ch == 'E') {
-                read_char();
-                if (ch = input.peek(); ch == '+' || ch == '-') {
-                    read_char();
+            if (char ch = peek(); ch == 'e' || ch == 'E') {
+                ++pos;
+                if (ch = peek(); ch == '+' || ch == '-') {
+                    ++pos;
                 }
                 read_digits();
-                is_int = false;
+                number.is_int = false;
             }
 
-            try {
-                if (is_int) {
-                    // Сначала пробуем преобразовать строку в int
-                    try {
-                        return std::stoi(parsed_num);
-                    }
-                    catch (...) {
-                        // В случае неудачи, например, при переполнении,
-                        // код ниже попробует преобразовать строку в double
-                    }
+            if (number.is_int) {
+                // Сначала пробуем преобразовать строку в int. В случае неудачи,
+                // например, при переполнении, код ниже преобразует строку в double
+                if (const auto [ptr, ec] = std::from_chars(start, pos, number.int_value); ec == std::errc() && ptr == pos) {
+                    return number;
                 }
-                return std::stod(parsed_num);
+                number.is_int = false;
             }
-            catch (...) {
-                throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
+            if (const auto [ptr, ec] = std::from_chars(start, pos, number.double_value); ec != std::errc() || ptr != pos) {
+                throw ParsingError("Failed to convert "s + std::string(start, pos) + " to number"s);
             }
+            return number;
         }
 
-        // Считывает содержимое строкового литерала JSON-документа
-        // Функцию следует использовать после считывания открывающего символа ":
-        Node LoadString(std::istream& input) {
-            using namespace std::literals;
+    }  // namespace detail
 
-            auto it = std::istreambuf_iterator<char>(input);
-            auto end = std::istreambuf_iterator<char>();
-            std::string s;
-            while (true) {
-                if (it == end) {
-                    // Поток закончился до того, как встретили закрывающую кавычку?
-                    throw ParsingError("String parsing error");
+    namespace {
+
+        // Разбирает JSON из непрерывного буфера [pos, end), сдвигая pos по мере чтения
+        class Parser {
+        public:
+            Parser(const char*& pos, const char* end)
+                : pos_(pos)
+                , end_(end) {
+            }
+
+            // Пропускает пробелы и читает очередной значимый символ
+            bool Next(char& ch) {
+                pos_ = detail::SkipSpaces(pos_, end_);
+                if (pos_ == end_) {
+                    return false;
                 }
-                const char ch = *it;
-                if (ch == '"') {
-                    // Встретили закрывающую кавычку
-                    ++it;
-                    break;
+                ch = *pos_++;
+                return true;
+            }
+
+            void PutBack() {
+                --pos_;
+            }
+
+            Node LoadNode() {
+                char c;
+                if (!Next(c)) {
+                    throw ParsingError(""s);
                 }
-                else if (ch == '\\') {
-                    // Встретили начало escape-последовательности
-                    ++it;
-                    if (it == end) {
-                        // Поток завершился сразу после символа обратной косой черты
-                        throw ParsingError("String parsing error");
-                    }
-                    const char escaped_char = *(it);
-                    // Обрабатываем одну из последовательностей: \\, \n, \t, \r, \"
-                    switch (escaped_char) {
-                    case 'n':
-                        s.push_back('\n');
-                        break;
-                    case 't':
-                        s.push_back('\t');
-                        break;
-                    case 'r':
-                        s.push_back('\r');
-                        break;
-                    case '"':
-                        s.push_back('"');
-                        break;
-                    case '\\':
-                        s.push_back('\\');
-                        break;
-                    default:
-                        // Встретили неизвестную escape-последовательность
-                        throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
-                    }
+                else if (c == '[') {
+                    return LoadArray();
                 }
-                else if (ch == '\n' || ch == '\r') {
-                    // Строковый литерал внутри- JSON не может прерываться символами \r или \n
-                    throw ParsingError("Unexpected end of line"s);
+                else if (c == '{') {
+                    return LoadDict();
+                }
+                else if (c == '"') {
+                    return LoadString();
+                }
+                else if (c == 'n') {
+                    PutBack();
+                    return LoadNull();
+                }
+                else if (c == 't' || c == 'f') {
+                    PutBack();
+                    return LoadBool();
                 }
                 else {
-                    // Просто считываем очередной символ и помещаем его в результирующую строку
-                    s.push_back(ch);
+                    PutBack();
+                    return LoadNumber();
                 }
-                ++it;
             }
 
-            return s;
-        }
-        Node LoadDict(std::istream& input) {
-            Dict dict;
-            for (char ch; input >> ch && ch != '}';) {
-                if (ch == '"') {
-                    std::string key = LoadString(input).AsString(); 
-                    if (input >> ch && ch == ':') {
-                        if (dict.find(key) != dict.end()) {
+            std::string LoadString() {
+                std::string s;
+                detail::ScanString(pos_, end_, s);
+                return s;
+            }
+
+        private:
+            Node LoadArray() {
+                Array result;
+                char c;
+                bool closed = false;
+                while (Next(c)) {
+                    if (c == ']') {
+                        closed = true;
+                        break;
+                    }
+                    if (c != ',') {
+                        PutBack();
+                    }
+                    result.push_back(LoadNode());
+                }
+                if (!closed) {
+                    throw ParsingError("");
+                }
+                return Node(move(result));
+            }
+
+            Node LoadDict() {
+                Dict dict;
+                char ch;
+                bool closed = false;
+                while (Next(ch)) {
+                    if (ch == '}') {
+                        closed = true;
+                        break;
+                    }
+                    if (ch == '"') {
+                        std::string key = LoadString();
+                        if (Next(ch) && ch == ':') {
+                            if (dict.find(key) != dict.end()) {
+                                throw ParsingError("");
+                            }
+                            dict.emplace(std::move(key), LoadNode());
+                        }
+                        else {
                             throw ParsingError("");
                         }
-                        dict.emplace(std::move(key), LoadNode(input));
                     }
-                    else {
+                    else if (ch != ',') {
                         throw ParsingError("");
                     }
                 }
-                else if (ch != ',') {
+                if (!closed) {
                     throw ParsingError("");
                 }
+                return Node(move(dict));
             }
-            if (!input) {
-                throw ParsingError("");
-            }
-            return Node(dict);
 
-        }
-        
-        void LoadLiteral(std::istream& input, std::string& str) {
-            while (std::isalpha(input.peek())) {
-                str.push_back(static_cast<char>(input.get()));
-            }
-        }
-        Node LoadNull(std::istream& input) {
-            std::string str;
-            if (LoadLiteral(input, str); str != "null"sv) {
-                throw ParsingError("");
+            Node LoadNumber() {
+                const detail::NumberToken number = detail::ScanNumber(pos_, end_);
+                if (number.is_int) {
+                    return number.int_value;
+                }
+                return number.double_value;
             }
-            return Node(nullptr);
-        }
-        Node LoadBool(std::istream& input) {
-            std::string str;
-            LoadLiteral(input, str);
-            if (str == "true"sv) {
-                return Node(true);
+
+            Node LoadNull() {
+                if (detail::ScanLiteral(pos_, end_) != "null"sv) {
+                    throw ParsingError("");
+                }
+                return Node(nullptr);
             }
-            else if (str == "false"sv) {
-                return Node(false);
+
+            Node LoadBool() {
+                const std::string_view str = detail::ScanLiteral(pos_, end_);
+                if (str == "true"sv) {
+                    return Node(true);
+                }
+                else if (str == "false"sv) {
+                    return Node(false);
+                }
+                else {
+                    throw ParsingError("unable to parse '"s + std::string(str) + "' as bool"s);
+                }
             }
-            else {
-                throw ParsingError("unable to parse '"s + str + "' as bool"s);
+
+            const char*& pos_;
+            const char* end_;
+        };
+
+    }  // namespace
+
+    std::string ReadAll(std::istream& input) {
+        TRACE_SCOPE("json::ReadAll");
+        std::string buffer;
+        std::streambuf* stream = input.rdbuf();
+        // У файла (в том числе перенаправленного в stdin) размер известен:
+        // буфер выделяется сразу нужного размера и заполняется одним чтением
+        const auto begin = stream->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+        if (begin != std::streampos(-1)) {
+            const auto end = stream->pubseekoff(0, std::ios_base::end, std::ios_base::in);
+            stream->pubseekpos(begin, std::ios_base::in);
+            if (end != std::streampos(-1) && end > begin) {
+                buffer.resize(static_cast<size_t>(end - begin));
+                buffer.resize(static_cast<size_t>(stream->sgetn(buffer.data(), static_cast<std::streamsize>(buffer.size()))));
             }
         }
-        Node LoadNode(istream& input) {
-            char c;
-            if (!(input >> c)) {
-                throw ParsingError(""s);
-            }
-            else if (c == '[') {
-                return LoadArray(input);
-            }
-            else if (c == '{') {
-                return LoadDict(input);
-            }
-            else if (c == '"') {
-                return LoadString(input);
-            }
-            else if (c == 'n') {
-                input.putback(c);
-                return LoadNull(input);
-            }
-            else if (c == 't' || c == 'f') {
-                input.putback(c);
-                return LoadBool(input);
-            }
-            else {
-                input.putback(c);
-                return LoadNumber(input);
+        // Канал читается кусками прямо в конец строки: она растёт геометрически,
+        // без промежуточного ostringstream и копии из него
+        while (stream->sgetc() != std::char_traits<char>::eof()) {
+            const size_t size = buffer.size();
+            buffer.resize(size + READ_CHUNK_SIZE);
+            const std::streamsize read = stream->sgetn(buffer.data() + size, static_cast<std::streamsize>(READ_CHUNK_SIZE));
+            buffer.resize(size + static_cast<size_t>(read));
+            if (read < static_cast<std::streamsize>(READ_CHUNK_SIZE)) {
+                break;
             }
         }
-    }  // namespace
+        return buffer;
+    }
 
     const Array& Node::AsArray() const { 
         if (!IsArray()) {
@@ -305,8 +366,78 @@ namespace json {
         return root_;
     }
 
+    Document Load(std::string_view input) {
+        TRACE_SCOPE("json::Load");
+        const char* pos = input.data();
+        return Document{ Parser(pos, input.data() + input.size()).LoadNode() };
+    }
+
     Document Load(istream& input) {
-        return Document{ LoadNode(input) };
+        return Load(ReadAll(input));
+    }
+
+    Reader::Reader(std::istream& input)
+        : buffer_(ReadAll(input))
+        , pos_(buffer_.data())
+        , end_(buffer_.data() + buffer_.size()) {
+    }
+
+    Reader::Reader(std::string_view input)
+        : pos_(input.data())
+        , end_(input.data() + input.size()) {
+    }
+
+    char Reader::ReadChar() {
+        char ch;
+        if (!Parser(pos_, end_).Next(ch)) {
+            throw ParsingError("Unexpected end of input"s);
+        }
+        return ch;
+    }
+
+    void Reader::BeginObject() {
+        if (ReadChar() != '{') {
+            throw ParsingError("Object is expected"s);
+        }
+    }
+
+    bool Reader::NextKey(std::string& key) {
+        char ch = ReadChar();
+        if (ch == '}') {
+            return false;
+        }
+        if (ch == ',') {
+            ch = ReadChar();
+        }
+        if (ch != '"') {
+            throw ParsingError("Object key is expected"s);
+        }
+        key = Parser(pos_, end_).LoadString();
+        if (ReadChar() != ':') {
+            throw ParsingError("':' is expected after object key"s);
+        }
+        return true;
+    }
+
+    void Reader::BeginArray() {
+        if (ReadChar() != '[') {
+            throw ParsingError("Array is expected"s);
+        }
+    }
+
+    bool Reader::NextElement() {
+        const char ch = ReadChar();
+        if (ch == ']') {
+            return false;
+        }
+        if (ch != ',') {
+            --pos_;
+        }
+        return true;
+    }
+
+    Node Reader::ReadNode() {
+        return Parser(pos_, end_).LoadNode();
     }
 
     template <typename Value>
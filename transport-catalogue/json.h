@@ -3,11 +3,13 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <variant>
 namespace json {
 
     class Node;
+    class ArenaDocument;
     // Сохраните объявления Dict и Array без изменения
     using Dict = std::map<std::string, Node>;
     using Array = std::vector<Node>;
@@ -87,8 +89,49 @@ namespace json {
     inline bool operator!=(const Document& lhs, const Document& rhs) {
         return !(lhs == rhs);
     }
+    // Разбирает JSON из непрерывного буфера (например, отображённого в память файла)
+    Document Load(std::string_view input);
+    // Читает поток целиком в буфер и разбирает его
     Document Load(std::istream& input);
 
+    // Читает поток до конца в одну строку. Вход целиком нужен парсерам как непрерывный
+    // буфер, поэтому лишних копий нет: у файла размер узнаётся заранее,
+    // а канал читается кусками прямо в результат
+    std::string ReadAll(std::istream& input);
+
+    /*
+     * Потоковый (pull) разбор JSON: позволяет пройти по объектам и массивам
+     * без построения дерева Node целиком. Поддерева, которые нужны целиком,
+     * можно прочитать через ReadNode
+     */
+    class Reader {
+    public:
+        // Читает поток целиком во внутренний буфер
+        explicit Reader(std::istream& input);
+        // Работает прямо по внешнему буферу, который должен жить дольше Reader
+        explicit Reader(std::string_view input);
+
+        // Ожидает начало объекта '{'
+        void BeginObject();
+        // Читает следующий ключ объекта и ':' после него. Возвращает false на '}'
+        bool NextKey(std::string& key);
+        // Ожидает начало массива '['
+        void BeginArray();
+        // Переходит к следующему элементу массива. Возвращает false на ']'
+        bool NextElement();
+        // Читает очередное значение целиком
+        Node ReadNode();
+        // Читает очередное значение в ArenaDocument. Строки документа могут
+        // указывать в буфер Reader, поэтому документ не должен его пережить
+        ArenaDocument ReadArenaDocument();
+
+    private:
+        std::string buffer_;
+        const char* pos_;
+        const char* end_;
+        char ReadChar();
+    };
+
     void Print(const Document& doc, std::ostream& output);
 
 }  // namespace json
\ No newline at end of file
@@ -0,0 +1,341 @@
+#include "json_arena.h"
+#include "json_scan.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+namespace json {
+
+    namespace {
+        const size_t MAX_INITIAL_ARENA_SIZE = 64 << 20;
+    }
+
+    /*
+     * Разбирает JSON прямо в арену. Элементы незакрытых массивов и объектов
+     * копятся в общих стеках values_ и members_, а при закрытии контейнера
+     * переносятся в арену одним непрерывным блоком
+     */
+    class ArenaParser {
+    public:
+        ArenaParser(const char*& pos, const char* end, std::pmr::memory_resource& arena)
+            : pos_(pos)
+            , end_(end)
+            , arena_(arena) {
+        }
+
+        const ArenaValue* ParseRoot() {
+            ArenaValue* root = Allocate<ArenaValue>(1);
+            *root = ParseValue();
+            return root;
+        }
+
+    private:
+        bool Next(char& ch) {
+            pos_ = detail::SkipSpaces(pos_, end_);
+            if (pos_ == end_) {
+                return false;
+            }
+            ch = *pos_++;
+            return true;
+        }
+
+        template <typename T>
+        T* Allocate(size_t count) {
+            if (count == 0) {
+                return nullptr;
+            }
+            return static_cast<T*>(arena_.allocate(count * sizeof(T), alignof(T)));
+        }
+
+        static uint32_t CheckedSize(size_t size) {
+            if (size > UINT32_MAX) {
+                throw ParsingError("Container is too large"s);
+            }
+            return static_cast<uint32_t>(size);
+        }
+
+        ArenaValue ParseValue() {
+            char c;
+            if (!Next(c)) {
+                throw ParsingError(""s);
+            }
+            ArenaValue value;
+            if (c == '[') {
+                return ParseArray();
+            }
+            else if (c == '{') {
+                return ParseDict();
+            }
+            else if (c == '"') {
+                const string_view str = ParseString();
+                value.type_ = ArenaValue::Type::STRING;
+                value.string_ = str.data();
+                value.size_ = CheckedSize(str.size());
+            }
+            else if (c == 'n') {
+                --pos_;
+                if (detail::ScanLiteral(pos_, end_) != "null"sv) {
+                    throw ParsingError("");
+                }
+                value.type_ = ArenaValue::Type::NUL;
+            }
+            else if (c == 't' || c == 'f') {
+                --pos_;
+                const string_view str = detail::ScanLiteral(pos_, end_);
+                if (str != "true"sv && str != "false"sv) {
+                    throw ParsingError("unable to parse '"s + string(str) + "' as bool"s);
+                }
+                value.type_ = ArenaValue::Type::BOOL;
+                value.bool_ = str == "true"sv;
+            }
+            else {
+                --pos_;
+                const detail::NumberToken number = detail::ScanNumber(pos_, end_);
+                if (number.is_int) {
+                    value.type_ = ArenaValue::Type::INT;
+                    value.int_ = number.int_value;
+                }
+                else {
+                    value.type_ = ArenaValue::Type::DOUBLE;
+                    value.double_ = number.double_value;
+                }
+            }
+            return value;
+        }
+
+        // Строки без escape-последовательностей не копируются, а указывают во входной буфер
+        string_view ParseString() {
+            const char* start = pos_;
+            const char* special = detail::FindStringSpecial(pos_, end_);
+            if (special != end_ && *special == '"') {
+                pos_ = special + 1;
+                return { start, static_cast<size_t>(special - start) };
+            }
+            scratch_.clear();
+            detail::ScanString(pos_, end_, scratch_);
+            char* data = Allocate<char>(scratch_.size());
+            copy(scratch_.begin(), scratch_.end(), data);
+            return { data, scratch_.size() };
+        }
+
+        ArenaValue ParseArray() {
+            const size_t base = values_.size();
+            char c;
+            bool closed = false;
+            while (Next(c)) {
+                if (c == ']') {
+                    closed = true;
+                    break;
+                }
+                if (c != ',') {
+                    --pos_;
+                }
+                ArenaValue element = ParseValue();
+                values_.push_back(element);
+            }
+            if (!closed) {
+                throw ParsingError("");
+            }
+            ArenaValue value;
+            value.type_ = ArenaValue::Type::ARRAY;
+            value.size_ = CheckedSize(values_.size() - base);
+            ArenaValue* elements = Allocate<ArenaValue>(value.size_);
+            uninitialized_copy(values_.begin() + base, values_.end(), elements);
+            value.array_ = elements;
+            values_.resize(base);
+            return value;
+        }
+
+        ArenaValue ParseDict() {
+            const size_t base = members_.size();
+            char ch;
+            bool closed = false;
+            while (Next(ch)) {
+                if (ch == '}') {
+                    closed = true;
+                    break;
+                }
+                if (ch == '"') {
+                    const string_view key = ParseString();
+                    if (!Next(ch) || ch != ':') {
+                        throw ParsingError("");
+                    }
+                    ArenaValue member_value = ParseValue();
+                    members_.push_back({ key, member_value });
+                }
+                else if (ch != ',') {
+                    throw ParsingError("");
+                }
+            }
+            if (!closed) {
+                throw ParsingError("");
+            }
+            auto by_key = [](const ArenaMember& lhs, const ArenaMember& rhs) {
+                return lhs.key < rhs.key;
+            };
+            sort(members_.begin() + base, members_.end(), by_key);
+            if (adjacent_find(members_.begin() + base, members_.end(), [](const ArenaMember& lhs, const ArenaMember& rhs) {
+                    return lhs.key == rhs.key; }) != members_.end()) {
+                throw ParsingError("");
+            }
+            ArenaValue value;
+            value.type_ = ArenaValue::Type::DICT;
+            value.size_ = CheckedSize(members_.size() - base);
+            ArenaMember* members = Allocate<ArenaMember>(value.size_);
+            uninitialized_copy(members_.begin() + base, members_.end(), members);
+            value.dict_ = members;
+            members_.resize(base);
+            return value;
+        }
+
+        const char*& pos_;
+        const char* end_;
+        std::pmr::memory_resource& arena_;
+        vector<ArenaValue> values_;
+        vector<ArenaMember> members_;
+        string scratch_;
+    };
+
+    bool ArenaValue::IsNull() const {
+        return type_ == Type::NUL;
+    }
+    bool ArenaValue::IsArray() const {
+        return type_ == Type::ARRAY;
+    }
+    bool ArenaValue::IsMap() const {
+        return type_ == Type::DICT;
+    }
+    bool ArenaValue::IsBool() const {
+        return type_ == Type::BOOL;
+    }
+    bool ArenaValue::IsInt() const {
+        return type_ == Type::INT;
+    }
+    bool ArenaValue::IsPureDouble() const {
+        return type_ == Type::DOUBLE;
+    }
+    bool ArenaValue::IsDouble() const {
+        return type_ == Type::DOUBLE || type_ == Type::INT;
+    }
+    bool ArenaValue::IsString() const {
+        return type_ == Type::STRING;
+    }
+
+    ArenaValue::ArrayRange ArenaValue::AsArray() const {
+        if (!IsArray()) {
+            throw std::logic_error("");
+        }
+        return { array_, array_ + size_ };
+    }
+    ArenaValue::DictRange ArenaValue::AsMap() const {
+        if (!IsMap()) {
+            throw std::logic_error("");
+        }
+        return { dict_, dict_ + size_ };
+    }
+    bool ArenaValue::AsBool() const {
+        if (!IsBool()) {
+            throw std::logic_error("");
+        }
+        return bool_;
+    }
+    int ArenaValue::AsInt() const {
+        if (!IsInt()) {
+            throw std::logic_error("");
+        }
+        return int_;
+    }
+    double ArenaValue::AsDouble() const {
+        if (!IsDouble()) {
+            throw std::logic_error("");
+        }
+        return IsPureDouble() ? double_ : int_;
+    }
+    string_view ArenaValue::AsString() const {
+        if (!IsString()) {
+            throw std::logic_error("");
+        }
+        return { string_, size_ };
+    }
+
+    const ArenaValue* ArenaValue::Find(string_view key) const {
+        const DictRange members = AsMap();
+        const ArenaMember* it = lower_bound(members.begin(), members.end(), key,
+            [](const ArenaMember& member, string_view key) { return member.key < key; });
+        return it != members.end() && it->key == key ? &it->value : nullptr;
+    }
+
+    const ArenaValue& ArenaValue::At(string_view key) const {
+        if (const ArenaValue* value = Find(key)) {
+            return *value;
+        }
+        throw std::out_of_range("No such key: "s + string(key));
+    }
+
+    Node ArenaValue::ToNode() const {
+        switch (type_) {
+        case Type::ARRAY: {
+            Array arr;
+            arr.reserve(size_);
+            for (const ArenaValue& element : AsArray()) {
+                arr.push_back(element.ToNode());
+            }
+            return arr;
+        }
+        case Type::DICT: {
+            Dict dict;
+            for (const ArenaMember& member : AsMap()) {
+                dict.emplace_hint(dict.end(), string(member.key), member.value.ToNode());
+            }
+            return dict;
+        }
+        case Type::BOOL:
+            return bool_;
+        case Type::INT:
+            return int_;
+        case Type::DOUBLE:
+            return double_;
+        case Type::STRING:
+            return string(AsString());
+        default:
+            return nullptr;
+        }
+    }
+
+    ArenaDocument::ArenaDocument(std::istream& input) {
+        buffer_ = make_unique<const string>(ReadAll(input));
+        const char* pos = buffer_->data();
+        Parse(pos, pos + buffer_->size());
+    }
+
+    ArenaDocument::ArenaDocument(string_view input) {
+        const char* pos = input.data();
+        Parse(pos, pos + input.size());
+    }
+
+    void ArenaDocument::Parse(const char*& pos, const char* end) {
+        // Первый блок арены — размер входа, ограниченный снизу 4 КиБ и сверху 64 МиБ.
+        // Узел (16 байт) бывает и больше своего текста, и меньше; если блока не хватит,
+        // monotonic_buffer_resource выделит следующий, каждый раз больше предыдущего
+        const size_t initial_size = clamp<size_t>(static_cast<size_t>(end - pos), 4096, MAX_INITIAL_ARENA_SIZE);
+        arena_ = make_unique<std::pmr::monotonic_buffer_resource>(initial_size);
+        root_ = ArenaParser(pos, end, *arena_).ParseRoot();
+    }
+
+    const ArenaValue& ArenaDocument::GetRoot() const {
+        return *root_;
+    }
+
+    ArenaDocument Reader::ReadArenaDocument() {
+        TRACE_SCOPE("json::ReadArenaDocument");
+        ArenaDocument document;
+        document.Parse(pos_, end_);
+        return document;
+    }
+
+}  // namespace json
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "json.h"
+#include "ranges.h"
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+namespace json {
+
+    class ArenaValue;
+    struct ArenaMember;
+
+    /*
+     * Значение JSON внутри ArenaDocument. Массивы и объекты хранятся
+     * непрерывными массивами в арене документа (объекты — отсортированы по ключу),
+     * строки — указывают во входной буфер или в арену, если в них были escape-последовательности
+     */
+    class ArenaValue {
+    public:
+        using ArrayRange = ranges::Range<const ArenaValue*>;
+        using DictRange = ranges::Range<const ArenaMember*>;
+
+        bool IsNull() const;
+        bool IsArray() const;
+        bool IsMap() const;
+        bool IsBool() const;
+        bool IsInt() const;
+        bool IsPureDouble() const;
+        bool IsDouble() const;
+        bool IsString() const;
+
+        ArrayRange AsArray() const;
+        DictRange AsMap() const;
+        bool AsBool() const;
+        int AsInt() const;
+        double AsDouble() const;
+        std::string_view AsString() const;
+
+        // Ищет ключ в объекте двоичным поиском. Возвращает nullptr, если ключа нет
+        const ArenaValue* Find(std::string_view key) const;
+        // Как Find, но выбрасывает std::out_of_range, если ключа нет
+        const ArenaValue& At(std::string_view key) const;
+
+        // Копирует значение в обычное дерево Node
+        Node ToNode() const;
+
+    private:
+        friend class ArenaParser;
+
+        enum class Type : uint8_t {
+            NUL,
+            ARRAY,
+            DICT,
+            BOOL,
+            INT,
+            DOUBLE,
+            STRING,
+        };
+
+        Type type_ = Type::NUL;
+        uint32_t size_ = 0;
+        union {
+            bool bool_;
+            int int_;
+            double double_;
+            const char* string_;
+            const ArenaValue* array_;
+            const ArenaMember* dict_;
+        };
+    };
+
+    struct ArenaMember {
+        std::string_view key;
+        ArenaValue value;
+    };
+
+    /*
+     * Документ JSON, все узлы которого размещены в одной монотонной арене:
+     * загрузка делает несколько крупных выделений памяти вместо отдельного
+     * выделения на каждый узел, а освобождение — O(1)
+     */
+    class ArenaDocument {
+    public:
+        // Читает поток целиком во внутренний буфер и разбирает его
+        explicit ArenaDocument(std::istream& input);
+        // Разбирает внешний буфер, который должен жить дольше документа
+        explicit ArenaDocument(std::string_view input);
+
+        const ArenaValue& GetRoot() const;
+
+    private:
+        friend class Reader;
+
+        ArenaDocument() = default;
+        void Parse(const char*& pos, const char* end);
+
+        std::unique_ptr<const std::string> buffer_;
+        std::unique_ptr<std::pmr::monotonic_buffer_resource> arena_;
+        const ArenaValue* root_ = nullptr;
+    };
+
+}  // namespace json
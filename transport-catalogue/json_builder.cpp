@@ -8,68 +8,47 @@ namespace json {
     }
     Builder::KeyItemContext Builder::Key(std::string key_) {
         EmptyException();
-        if (nodes_stack_.top()->IsMap()) {
-            nodes_stack_.push(new Node(key_));
+        if (!nodes_stack_.back()->IsMap() || has_key_) {
+            throw std::logic_error("");
         }
+        this->key_ = std::move(key_);
+        has_key_ = true;
         return *this;
     }
 
     Builder::DictItemContext Builder::StartDict() {
-        nodes_stack_.push(new Node(Dict()));
+        nodes_stack_.push_back(Push(Dict()));
         return *this;
     }
 
     Builder::ArrayItemContext Builder::StartArray() {
-        nodes_stack_.push(new Node(Array()));
+        nodes_stack_.push_back(Push(Array()));
         return *this;
     }
 
     Builder& Builder::EndDict() {
         EmptyException();
-        if (Node node = *nodes_stack_.top(); !node.IsMap()) {
+        if (!nodes_stack_.back()->IsMap() || has_key_) {
             throw std::logic_error("");
         }
-        else {
-            nodes_stack_.pop();
-            Push(node);
-        }
+        nodes_stack_.pop_back();
         return *this;
     }
 
     Builder& Builder::EndArray() {
         EmptyException();
-        if (Node node = *nodes_stack_.top(); !node.IsArray()) {
+        if (!nodes_stack_.back()->IsArray()) {
             throw std::logic_error("");
         }
-        else {
-            nodes_stack_.pop();
-            Push(node);
-        }
+        nodes_stack_.pop_back();
         return *this;
     }
 
     Builder& Builder::Value(Node::Value value) {
-        if (std::holds_alternative<Array>(value)) {
-            Push(Node(std::get<Array>(value)));
-        }
-        else if (std::holds_alternative<Dict>(value)) {
-            Push(Node(std::get<Dict>(value)));
-        }
-        else if (std::holds_alternative<bool>(value)) {
-            Push(Node(std::get<bool>(value)));
-        }
-        else if (std::holds_alternative<int>(value)) {
-            Push(Node(std::get<int>(value)));
-        }
-        else if (std::holds_alternative<double>(value)) {
-            Push(Node(std::get<double>(value)));
-        }
-        else if (std::holds_alternative<std::string>(value)) {
-            Push(Node(std::get<std::string>(value)));
-        }
-        else {
-            Push(Node());
-        }
+        // Присваивание вместо Node(std::move(value)): на нём GCC 12 выдаёт ложное -Wmaybe-uninitialized
+        Node node;
+        node.GetValue() = std::move(value);
+        Push(std::move(node));
         return *this;
     }
 
@@ -77,23 +56,38 @@ namespace json {
         if (root_.IsNull() || !nodes_stack_.empty()) {
             throw std::logic_error("");
         }
-        return root_;
+        Node result = std::move(root_);
+        Reset();
+        return result;
+    }
+
+    void Builder::Reset() {
+        root_ = Node();
+        nodes_stack_.clear();
+        key_.clear();
+        has_key_ = false;
     }
 
-    void Builder::Push(Node node) {
+    // Размещает узел в текущем контейнере и возвращает указатель на него.
+    // Указатель остаётся валидным, пока контейнер не получит следующий элемент,
+    // а это возможно только после закрытия вложенного узла
+    Node* Builder::Push(Node&& node) {
         if (nodes_stack_.empty() && root_.IsNull()) {
-            root_ = node;
+            root_ = std::move(node);
+            return &root_;
         }
-        else if (nodes_stack_.top()->IsString()) {
-            Node& top = *nodes_stack_.top();
-            nodes_stack_.pop();
-            const_cast<Dict&>(nodes_stack_.top()->AsMap()).emplace(top.AsString(), node);
+        if (nodes_stack_.empty()) {
+            throw std::logic_error("");
         }
-        else if (nodes_stack_.top()->IsArray()) {
-            const_cast<Array&>(nodes_stack_.top()->AsArray()).push_back(node);
+        Node::Value& top = nodes_stack_.back()->GetValue();
+        if (Dict* dict = std::get_if<Dict>(&top); dict && has_key_) {
+            has_key_ = false;
+            return &dict->emplace(std::move(key_), std::move(node)).first->second;
         }
-        else {
-            throw std::logic_error("");
+        if (Array* arr = std::get_if<Array>(&top)) {
+            arr->emplace_back(std::move(node));
+            return &arr->back();
         }
+        throw std::logic_error("");
     }
-}
\ No newline at end of file
+}
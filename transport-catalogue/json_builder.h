@@ -1,8 +1,15 @@
 #pragma once
 
 #include "json.h"
-#include <stack>
+#include <string>
+#include <vector>
 namespace json {
+	/*
+	 * Узлы строятся сразу на своём месте в дереве и перемещаются, а не копируются.
+	 * Build() забирает готовое дерево и возвращает Builder в исходное состояние,
+	 * поэтому один Builder можно переиспользовать между ответами: стек узлов
+	 * и буфер ключа сохраняют выделенную память
+	 */
 	class Builder {
 	private:
 		class ItemContext;
@@ -17,12 +24,16 @@ namespace json {
 		Builder& EndArray();
 		Builder& Value(Node::Value value_);
 		Node Build();
+		// Отбрасывает недостроенное дерево
+		void Reset();
 
 	private:
 		Node root_;
-		std::stack<Node*>nodes_stack_;
+		std::vector<Node*> nodes_stack_;
+		std::string key_;
+		bool has_key_ = false;
 		void EmptyException();
-		void Push(Node node);
+		Node* Push(Node&& node);
 		class ItemContext {
 		public:
 			ItemContext(Builder& builder) : builder_(builder) {};
@@ -36,7 +47,7 @@ namespace json {
 				return builder_.EndArray();
 			}
 			inline KeyItemContext Key(std::string key) {
-				return builder_.Key(key);
+				return builder_.Key(std::move(key));
 			}
 			inline Builder& EndDict() {
 				return builder_.EndDict();
@@ -49,7 +60,7 @@ namespace json {
 		public:
 			using ItemContext::ItemContext;
 			inline ArrayItemContext Value(Node::Value value) {
-				return builder_.Value(value);
+				return builder_.Value(std::move(value));
 			}
 
 			KeyItemContext Key(std::string key) = delete;
@@ -72,7 +83,7 @@ namespace json {
 		public:
 			using ItemContext::ItemContext;
 			inline DictItemContext Value(Node::Value value) {
-				return builder_.Value(value);
+				return builder_.Value(std::move(value));
 			}
 
 			KeyItemContext Key(std::string key) = delete;
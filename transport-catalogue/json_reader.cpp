@@ -1,15 +1,29 @@
 #include "json_reader.h"
+#include "json_arena.h"
 #include "json_builder.h"
+#include "json_writer.h"
+#include "parallel.h"
+#include "request_metrics.h"
+#include "serialization.h"
+#include "trace.h"
+
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
 using namespace std::literals;
 using namespace json;
 
 const double EPS_TO_CONVERT_VELOCITY = 1000./60.;
+// Сколько stat_requests рабочий поток забирает за раз в параллельном режиме
+const size_t STAT_CHUNK_SIZE = 256;
 
 Document LoadJSON(std::istream& input) {
     return Load(input);
 }
 
 static void ParseStops(const Array& arr, TrCatalogue& catalogue) {
+    TRACE_SCOPE("ParseStops");
     for (const auto& request : arr) {
         const auto& dict = request.AsMap();
         if (dict.find("type"s)->second.AsString() == "Stop"s) {
@@ -20,17 +34,22 @@ static void ParseStops(const Array& arr, TrCatalogue& catalogue) {
     }
 }
 static void ParseDistances(const Array& arr, TrCatalogue& catalogue) {
+    TRACE_SCOPE("ParseDistances");
     for (const auto& request : arr) {
         const auto& dict = request.AsMap();
         if (dict.find("type"s)->second.AsString() == "Stop"s) {
             TrCatalogue::constStopPtr first_stop = catalogue.FindStop(dict.at("name"s).AsString());
             for (const auto& [second_stop, distance] : dict.at("road_distances"s).AsMap()) {
-                catalogue.AddDistance(first_stop, catalogue.FindStop(second_stop), distance.AsInt());
+                // Расстояние до неизвестной остановки не может попасть ни в один маршрут
+                if (TrCatalogue::constStopPtr stop = catalogue.FindStop(second_stop)) {
+                    catalogue.AddDistance(first_stop, stop, distance.AsInt());
+                }
             }
         }
     }
 }
 static void ParseRoutes(const Array& arr, TrCatalogue& catalogue) {
+    TRACE_SCOPE("ParseRoutes");
     for (const auto& request : arr) {
         const auto& dict = request.AsMap();
         if (dict.find("type"s)->second.AsString() == "Bus"s) {
@@ -49,8 +68,108 @@ static void ParseRoutes(const Array& arr, TrCatalogue& catalogue) {
         }
     }
 }
-json::Node RequestError(int id) {
-    return json::Builder()
+// Запрос из base_requests, прочитанный потоково. Ключи в JSON могут идти в любом порядке,
+// поэтому тип запроса становится известен только после чтения всего объекта
+struct BaseRequest {
+    std::string type;
+    std::string name;
+    geo::Coordinates coordinates{ 0.0, 0.0 };
+    std::vector<std::pair<std::string, int>> road_distances;
+    std::vector<std::string> stops;
+    bool is_roundtrip = false;
+};
+
+struct PendingRoute {
+    std::string name;
+    std::vector<std::string> stops;
+    bool is_roundtrip = false;
+};
+
+static BaseRequest ReadBaseRequest(Reader& reader) {
+    BaseRequest request;
+    reader.BeginObject();
+    for (std::string key; reader.NextKey(key);) {
+        if (key == "type"s) {
+            request.type = reader.ReadNode().AsString();
+        }
+        else if (key == "name"s) {
+            request.name = reader.ReadNode().AsString();
+        }
+        else if (key == "latitude"s) {
+            request.coordinates.lat = reader.ReadNode().AsDouble();
+        }
+        else if (key == "longitude"s) {
+            request.coordinates.lng = reader.ReadNode().AsDouble();
+        }
+        else if (key == "road_distances"s) {
+            reader.BeginObject();
+            for (std::string stop; reader.NextKey(stop);) {
+                request.road_distances.emplace_back(std::move(stop), reader.ReadNode().AsInt());
+            }
+        }
+        else if (key == "stops"s) {
+            reader.BeginArray();
+            while (reader.NextElement()) {
+                request.stops.push_back(reader.ReadNode().AsString());
+            }
+        }
+        else if (key == "is_roundtrip"s) {
+            request.is_roundtrip = reader.ReadNode().AsBool();
+        }
+        else {
+            reader.ReadNode();
+        }
+    }
+    return request;
+}
+
+// Остановки добавляются сразу, а расстояния и маршруты откладываются до конца массива,
+// так как могут ссылаться на остановки, описанные позже
+static void LoadBaseRequests(Reader& reader, TrCatalogue& catalogue) {
+    std::vector<std::pair<std::string, std::vector<std::pair<std::string, int>>>> pending_distances;
+    std::vector<PendingRoute> pending_routes;
+    {
+        TRACE_SCOPE("ParseStops");
+        reader.BeginArray();
+        while (reader.NextElement()) {
+            BaseRequest request = ReadBaseRequest(reader);
+            if (request.type == "Stop"s) {
+                catalogue.AddStop(request.name, request.coordinates);
+                if (!request.road_distances.empty()) {
+                    pending_distances.emplace_back(std::move(request.name), std::move(request.road_distances));
+                }
+            }
+            else if (request.type == "Bus"s) {
+                pending_routes.push_back({ std::move(request.name), std::move(request.stops), request.is_roundtrip });
+            }
+        }
+    }
+    {
+        TRACE_SCOPE("ParseDistances");
+        for (const auto& [name, road_distances] : pending_distances) {
+            TrCatalogue::constStopPtr first_stop = catalogue.FindStop(name);
+            for (const auto& [second_stop, distance] : road_distances) {
+                // Расстояние до неизвестной остановки не может попасть ни в один маршрут
+                if (TrCatalogue::constStopPtr stop = catalogue.FindStop(second_stop)) {
+                    catalogue.AddDistance(first_stop, stop, distance);
+                }
+            }
+        }
+    }
+    TRACE_SCOPE("ParseRoutes");
+    for (const PendingRoute& route : pending_routes) {
+        std::vector<std::string_view> stops(route.stops.begin(), route.stops.end());
+        std::string last_stop(stops.back());
+        if (!route.is_roundtrip) {
+            stops.insert(stops.end(), std::next(stops.rbegin()), stops.rend());
+        }
+        catalogue.AddRoute(route.name, stops, last_stop);
+    }
+    catalogue.Finalize();
+}
+
+json::Node RequestError(json::Builder& builder, int id) {
+    return builder
         .StartDict()
         .Key("request_id"s).Value(id)
         .Key("error_message"s).Value("not found"s)
@@ -58,109 +177,235 @@ json::Node RequestError(int id) {
         .Build();
 }
 
-static void PrintStat(const Array& arr
-    , const TrCatalogue& catalogue
-    , const RenderSettings& rs
-    , const RoutingSettings& routing_settings
-    , const Transport_router& transport_router) {
+// Запрос из stat_requests. Строки указывают в документ, из которого запрос прочитан
+struct StatRequest {
+    int id = 0;
+    std::string_view type;
+    std::string_view name;
+    std::optional<std::string_view> from;
+    std::optional<std::string_view> to;
+};
 
+static StatRequest ReadStatRequest(const Node& request) {
+    const auto& dict = request.AsMap();
+    StatRequest stat_request;
+    stat_request.id = dict.at("id"s).AsInt();
+    stat_request.type = dict.at("type"s).AsString();
+    if (const auto it = dict.find("name"s); it != dict.end()) {
+        stat_request.name = it->second.AsString();
+    }
+    if (const auto it = dict.find("from"s); it != dict.end()) {
+        stat_request.from = it->second.AsString();
+    }
+    if (const auto it = dict.find("to"s); it != dict.end()) {
+        stat_request.to = it->second.AsString();
+    }
+    return stat_request;
+}
 
-    Array result;
-    for (const auto& request : arr) {
-        const auto& dict = request.AsMap();
-        const auto& request_type = dict.find("type"s);
-        
-        if (request_type->second.AsString() == "Bus"s) {
-            auto& name = dict.at("name").AsString();
-            if (catalogue.FindRoute(name)) {
-                const auto [count_of_stops, count_of_unique_stops, route_length, curvature] = catalogue.GetRoute(name);
-                result.emplace_back(json::Builder()
-                    .StartDict()
-                    .Key("curvature"s).Value(curvature)
-                    .Key("request_id"s).Value(dict.at("id").AsInt())
-                    .Key("route_length"s).Value(route_length)
-                    .Key("stop_count"s).Value(static_cast<int>(count_of_stops))
-                    .Key("unique_stop_count"s).Value(static_cast<int>(count_of_unique_stops))
-                    .EndDict()
-                    .Build());
-            }
-            else {
-                result.emplace_back(RequestError(dict.at("id").AsInt()));
-            }
+// Типы полей проверяются здесь: json бросает logic_error без текста,
+// а по сообщению клиент должен понять, что не так с запросом
+static StatRequest ReadStatRequest(const ArenaValue& request) {
+    if (!request.IsMap()) {
+        throw std::invalid_argument("Stat request must be an object"s);
+    }
+    auto read_string = [&request](std::string_view key) -> std::optional<std::string_view> {
+        const ArenaValue* value = request.Find(key);
+        if (!value) {
+            return std::nullopt;
         }
-        else if (request_type->second.AsString() == "Stop"s) {
-            auto& name = dict.at("name").AsString();
-            if (catalogue.FindStop(name)) {
-                std::set<std::string_view> routes = catalogue.GetRoutesOfStop(name);
-                Array arr;
-                for (auto& route : routes) {
-                    arr.emplace_back(std::string(route));
-                }
-                result.emplace_back(json::Builder()
-                            .StartDict()
-                            .Key("buses"s).Value(arr)
-                            .Key("request_id"s).Value(dict.at("id").AsInt())
-                            .EndDict()
-                            .Build());
-            }
-            else {
-                result.emplace_back(RequestError(dict.at("id").AsInt()));
-            }
+        if (!value->IsString()) {
+            throw std::invalid_argument("Field "s + std::string(key) + " of stat request must be a string"s);
         }
-        else if (request_type->second.AsString() == "Map"s) {
-            MapRenderer rndr(rs, catalogue.GetSortedRoutes(), catalogue.GetSortedStops());
-            result.emplace_back(json::Builder()
-                .StartDict()
-                .Key("map"s).Value(rndr.GetMap())
-                .Key("request_id"s).Value(dict.at("id").AsInt())
-                .EndDict()
-                .Build());
-        }
-        else if (request_type->second.AsString() == "Route"s) {
-            const auto from_it = dict.find("from"s);
-            const auto to_it = dict.find("to"s);
-            
-            if (from_it != dict.end() && to_it != dict.end()) {
-                auto route_stat = transport_router.GetOptimalRoute(from_it->second.AsString(), to_it->second.AsString());
-                if (route_stat == std::nullopt) {
-                    result.emplace_back(RequestError(dict.at("id").AsInt()));
-                    continue;
-                }
+        return value->AsString();
+    };
+    const ArenaValue* id = request.Find("id"sv);
+    if (!id || !id->IsInt()) {
+        throw std::invalid_argument("Field id of stat request must be an integer"s);
+    }
+    const auto type = read_string("type"sv);
+    if (!type) {
+        throw std::invalid_argument("Field type of stat request is required"s);
+    }
+    StatRequest stat_request;
+    stat_request.id = id->AsInt();
+    stat_request.type = *type;
+    stat_request.name = read_string("name"sv).value_or(""sv);
+    stat_request.from = read_string("from"sv);
+    stat_request.to = read_string("to"sv);
+    return stat_request;
+}
 
-                Array arr;
-                for (const auto& item : route_stat.value().items) {
-                    arr.emplace_back(json::Builder()
-                        .StartDict()
-                        .Key("type"s).Value("Wait"s)
-                        .Key("stop_name"s).Value(item.stop->name)
-                        .Key("time"s).Value(routing_settings.bus_wait_time)
-                        .EndDict().Build());
-                    
-                    arr.emplace_back(json::Builder()
-                        .StartDict()
-                        .Key("type"s).Value("Bus"s)
-                        .Key("bus"s).Value(item.bus->name)
-                        .Key("span_count"s).Value(item.span_count)
-                        .Key("time"s).Value(item.time)
-                        .EndDict().Build());
-                    
-                }
+// Всё, что нужно для ответа на запрос. Ответы только читают каталог и маршрутизатор,
+// поэтому один контекст можно использовать из нескольких потоков одновременно
+struct StatContext {
+    const TrCatalogue& catalogue;
+    const MapCache& map_cache;
+    const RoutingSettings& routing_settings;
+    const Transport_router& transport_router;
+};
 
-                result.emplace_back(json::Builder()
-                    .StartDict()
-                    .Key("request_id"s).Value(dict.at("id").AsInt())
-                    .Key("total_time"s)
-                    .Value(route_stat.value().total_time)
-                    .Key("items"s).Value(std::move(arr))
-                    .EndDict()
-                    .Build());
-            }
-            else {
-                result.emplace_back(RequestError(dict.at("id").AsInt()));
-            }
+// Возвращает false, если вместо ответа записано сообщение об ошибке
+static bool WriteStatAnswer(const StatRequest& request, json::Builder& builder, const StatContext& context, Writer& writer) {
+    const TrCatalogue& catalogue = context.catalogue;
+    if (request.type == "Bus"sv) {
+        const std::string_view name = request.name;
+        if (!catalogue.FindRoute(name)) {
+            writer.Value(RequestError(builder, request.id));
+            return false;
+        }
+        const auto [count_of_stops, count_of_unique_stops, route_length, curvature] = catalogue.GetRoute(name);
+        writer.Value(builder
+            .StartDict()
+            .Key("curvature"s).Value(curvature)
+            .Key("request_id"s).Value(request.id)
+            .Key("route_length"s).Value(route_length)
+            .Key("stop_count"s).Value(static_cast<int>(count_of_stops))
+            .Key("unique_stop_count"s).Value(static_cast<int>(count_of_unique_stops))
+            .EndDict()
+            .Build());
+        return true;
+    }
+    if (request.type == "Stop"sv) {
+        const std::string_view name = request.name;
+        if (!catalogue.FindStop(name)) {
+            writer.Value(RequestError(builder, request.id));
+            return false;
+        }
+        builder.StartDict()
+            .Key("request_id"s).Value(request.id)
+            .Key("buses"s).StartArray();
+        for (const Route* route : catalogue.GetRoutesOfStop(name)) {
+            builder.Value(route->name);
+        }
+        writer.Value(builder.EndArray().EndDict().Build());
+        return true;
+    }
+    if (request.type == "Map"sv) {
+        // Карта пишется прямо из общего буфера, без копии в json::Node
+        const std::shared_ptr<const std::string> map = context.map_cache.Get();
+        writer.StartDict()
+            .Key("map"sv).Value(std::string_view(*map))
+            .Key("request_id"sv).Value(request.id)
+            .EndDict();
+        return true;
+    }
+    if (request.type == "Route"sv) {
+        if (!request.from || !request.to) {
+            writer.Value(RequestError(builder, request.id));
+            return false;
+        }
+        auto route_stat = context.transport_router.GetOptimalRoute(*request.from, *request.to);
+        if (route_stat == std::nullopt) {
+            writer.Value(RequestError(builder, request.id));
+            return false;
         }
+        builder.StartDict()
+            .Key("request_id"s).Value(request.id)
+            .Key("total_time"s)
+            .Value(route_stat.value().total_time)
+            .Key("items"s).StartArray();
+        for (const auto& item : route_stat.value().items) {
+            builder.StartDict()
+                .Key("type"s).Value("Wait"s)
+                .Key("stop_name"s).Value(item.stop->name)
+                .Key("time"s).Value(context.routing_settings.bus_wait_time)
+                .EndDict();
+
+            builder.StartDict()
+                .Key("type"s).Value("Bus"s)
+                .Key("bus"s).Value(item.bus->name)
+                .Key("span_count"s).Value(item.span_count)
+                .Key("time"s).Value(item.time)
+                .EndDict();
+        }
+        writer.Value(builder.EndArray().EndDict().Build());
+    }
+    return true;
+}
+
+// Отвечает на запрос и, если metrics задан, записывает в него время ответа и ошибку.
+// Без метрик часы не читаются вовсе
+static void WriteStatAnswer(const StatRequest& request, json::Builder& builder, const StatContext& context, Writer& writer
+    , metrics::RequestMetrics* request_metrics) {
+    if (!request_metrics) {
+        WriteStatAnswer(request, builder, context, writer);
+        return;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const bool answered = WriteStatAnswer(request, builder, context, writer);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    if (const auto type = metrics::ParseRequestType(request.type)) {
+        request_metrics->Record(*type, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count())
+            , !answered);
+    }
+}
+
+// Ответы, отформатированные в рабочем потоке: текст подряд и границы каждого ответа
+struct FormattedAnswers {
+    std::string text;
+    std::vector<size_t> ends;
+};
+
+// Если request_metrics задан, в него добавляются время и результат каждого ответа
+static void PrintStat(const std::vector<StatRequest>& requests, const StatContext& context, size_t thread_count
+    , metrics::RequestMetrics* request_metrics, std::ostream& output = std::cout, Writer::Format format = Writer::Format::PRETTY) {
+    TRACE_SCOPE("PrintStat");
+    // Ответы пишутся в поток сразу по готовности, в памяти держится только текущий.
+    // Builder общий для всех ответов: его стек и буфер ключа не выделяются заново
+    Writer writer(output, 0, format);
+    writer.StartArray();
+    if (thread_count <= 1) {
+        json::Builder builder;
+        for (const StatRequest& request : requests) {
+            WriteStatAnswer(request, builder, context, writer, request_metrics);
+        }
+    }
+    else {
+        // Запросы делятся на блоки, которые потоки разбирают по мере освобождения.
+        // Каждый ответ форматируется там же, где посчитан, а в вывод блоки
+        // попадают в исходном порядке запросов
+        const std::streamsize precision = output.precision();
+        std::mutex metrics_mutex;
+        parallel::OrderedForEachChunk(requests.size(), STAT_CHUNK_SIZE, thread_count,
+            [&](size_t begin, size_t end) {
+                TRACE_SCOPE("PrintStat chunk");
+                std::ostringstream stream;
+                stream.precision(precision);
+                FormattedAnswers answers;
+                json::Builder builder;
+                Writer chunk_writer(stream, 1, format);
+                // Метрики копятся в блоке и сливаются в общие один раз на блок
+                std::optional<metrics::RequestMetrics> chunk_metrics;
+                if (request_metrics) {
+                    chunk_metrics.emplace();
+                }
+                size_t written = 0;
+                for (size_t i = begin; i < end; ++i) {
+                    WriteStatAnswer(requests[i], builder, context, chunk_writer, chunk_metrics ? &*chunk_metrics : nullptr);
+                    chunk_writer.Flush();
+                    if (const size_t size = static_cast<size_t>(stream.tellp()); size != written) {
+                        answers.ends.push_back(size);
+                        written = size;
+                    }
+                }
+                if (chunk_metrics) {
+                    std::lock_guard guard(metrics_mutex);
+                    request_metrics->Merge(*chunk_metrics);
+                }
+                answers.text = stream.str();
+                return answers;
+            },
+            [&writer](FormattedAnswers answers) {
+                const std::string_view text = answers.text;
+                size_t begin = 0;
+                for (const size_t end : answers.ends) {
+                    writer.FormattedValue(text.substr(begin, end - begin));
+                    begin = end;
+                }
+            });
     }
-    Print(Document{ result }, std::cout);
+    writer.EndArray();
 }
 static svg::Color ParseColor(const Node& node) {
     if (node.IsString()) {
@@ -203,9 +448,105 @@ static RoutingSettings ParseRoutingSettings(const Dict& dict) {
     RoutingSettings routing_settings;
     routing_settings.bus_wait_time = dict.at("bus_wait_time"s).AsInt();
     routing_settings.bus_velocity = dict.at("bus_velocity"s).AsDouble() * EPS_TO_CONVERT_VELOCITY;
+    if (const auto mode = dict.find("search_mode"s); mode != dict.end()) {
+        const std::string& name = mode->second.AsString();
+        if (name == "dijkstra"s) {
+            routing_settings.search_mode = graph::SearchMode::DIJKSTRA;
+        }
+        else if (name == "bidirectional"s) {
+            routing_settings.search_mode = graph::SearchMode::BIDIRECTIONAL;
+        }
+        else {
+            // Опечатка не должна молча менять алгоритм поиска
+            throw std::invalid_argument("Unknown search_mode "s + name);
+        }
+    }
     return routing_settings;
 }
 
+// По умолчанию запросы обрабатываются в одном потоке; thread_count = 0 — по числу ядер
+static size_t ReadThreadCount(const Dict& root) {
+    if (const auto& settings = root.find("execution_settings"s); settings != root.end()) {
+        const Dict& dict = settings->second.AsMap();
+        if (const auto count = dict.find("thread_count"s); count != dict.end()) {
+            return parallel::ResolveThreadCount(static_cast<size_t>(count->second.AsInt()));
+        }
+    }
+    return 1;
+}
+
+// Куда писать отчёт о задержках stat_requests: "stderr" или путь к файлу.
+// Пустая строка — метрики не собираются
+static std::string ReadMetricsReport(const Dict& root) {
+    if (const auto& settings = root.find("execution_settings"s); settings != root.end()) {
+        const Dict& dict = settings->second.AsMap();
+        if (const auto report = dict.find("metrics_report"s); report != dict.end()) {
+            return report->second.AsString();
+        }
+    }
+    return {};
+}
+
+static RenderSettings ReadRenderSettings(const Dict& root) {
+    if (const auto& settings = root.find("render_settings"s); settings != root.end()) {
+        return ParseRenderSettings(settings->second.AsMap());
+    }
+    return {};
+}
+
+static RoutingSettings ReadRoutingSettings(const Dict& root) {
+    if (const auto& settings = root.find("routing_settings"s); settings != root.end()) {
+        return ParseRoutingSettings(settings->second.AsMap());
+    }
+    return {};
+}
+
+static std::string ReadSerializationFile(const Dict& root) {
+    return root.at("serialization_settings"s).AsMap().at("file"s).AsString();
+}
+
+static std::vector<StatRequest> ReadStatRequests(const std::optional<ArenaDocument>& requests_document) {
+    std::vector<StatRequest> stat_requests;
+    if (requests_document) {
+        if (!requests_document->GetRoot().IsArray()) {
+            throw std::invalid_argument("stat_requests must be an array"s);
+        }
+        for (const ArenaValue& request : requests_document->GetRoot().AsArray()) {
+            stat_requests.push_back(ReadStatRequest(request));
+        }
+    }
+    return stat_requests;
+}
+
+static void AnswerRequests(const std::vector<StatRequest>& stat_requests, const TrCatalogue& catalogue
+    , const RenderSettings& render_settings
+    , const RoutingSettings& routing_settings
+    , const Transport_router& transport_router
+    , size_t thread_count
+    , const std::string& metrics_report) {
+    const MapCache map_cache(catalogue, render_settings);
+    std::optional<metrics::RequestMetrics> request_metrics;
+    if (!metrics_report.empty()) {
+        request_metrics.emplace();
+    }
+    if (!stat_requests.empty()) {
+        PrintStat(stat_requests, { catalogue, map_cache, routing_settings, transport_router }, thread_count
+            , request_metrics ? &*request_metrics : nullptr);
+    }
+    if (request_metrics) {
+        metrics::WriteReport(*request_metrics, metrics_report);
+    }
+}
+
+static void AnswerRequests(const Dict& root, const std::vector<StatRequest>& stat_requests, TrCatalogue& catalogue) {
+    const RenderSettings render_settings = ReadRenderSettings(root);
+    const RoutingSettings routing_settings = ReadRoutingSettings(root);
+    const size_t thread_count = ReadThreadCount(root);
+    Transport_router transport_router(catalogue, routing_settings, thread_count);
+    AnswerRequests(stat_requests, catalogue, render_settings, routing_settings, transport_router, thread_count
+        , ReadMetricsReport(root));
+}
+
 void ParseJson(const Document& document, TrCatalogue& catalogue) { 
     const Dict& root  = document.GetRoot().AsMap();
     if (const auto& base_requests = root.find("base_requests"s); base_requests != root.end()) {
@@ -213,21 +554,187 @@ void ParseJson(const Document& document, TrCatalogue& catalogue) {
         ParseStops(arr, catalogue);
         ParseDistances(arr, catalogue);
         ParseRoutes(arr, catalogue);
+        catalogue.Finalize();
     }
-    RenderSettings render_settings;
-    if (const auto& settings = root.find("render_settings"s); settings != root.end()) {
-        render_settings = ParseRenderSettings(settings->second.AsMap());
+    std::vector<StatRequest> stat_requests;
+    if (const auto& requests = root.find("stat_requests"s); requests != root.end()) {
+        for (const auto& request : requests->second.AsArray()) {
+            stat_requests.push_back(ReadStatRequest(request));
+        }
     }
-    RoutingSettings routing_settings;
-    if (const auto& settings = root.find("routing_settings"s); settings != root.end()) {
-        routing_settings = ParseRoutingSettings(settings->second.AsMap());
+    AnswerRequests(root, stat_requests, catalogue);
+}
+
+void ParseJson(std::istream& input, TrCatalogue& catalogue) {
+    Reader reader(input);
+    Dict root;
+    // stat_requests читаются в арену: запросов может быть очень много,
+    // а дерево Node выделяло бы память на каждый ключ и значение
+    std::optional<ArenaDocument> requests_document;
+    reader.BeginObject();
+    for (std::string key; reader.NextKey(key);) {
+        if (key == "base_requests"s) {
+            LoadBaseRequests(reader, catalogue);
+        }
+        else if (key == "stat_requests"s) {
+            requests_document.emplace(reader.ReadArenaDocument());
+        }
+        else {
+            root.emplace(std::move(key), reader.ReadNode());
+        }
+    }
+    AnswerRequests(root, ReadStatRequests(requests_document), catalogue);
+}
+
+void MakeBase(std::istream& input) {
+    Reader reader(input);
+    Dict root;
+    serialization::TransportBase base;
+    reader.BeginObject();
+    for (std::string key; reader.NextKey(key);) {
+        if (key == "base_requests"s) {
+            LoadBaseRequests(reader, base.catalogue);
+        }
+        else {
+            root.emplace(std::move(key), reader.ReadNode());
+        }
+    }
+    base.render_settings = ReadRenderSettings(root);
+    base.routing_settings = ReadRoutingSettings(root);
+    base.router.emplace(base.catalogue, base.routing_settings, ReadThreadCount(root));
+    serialization::SaveBase(ReadSerializationFile(root), base);
+}
+
+void ProcessRequests(std::istream& input) {
+    Reader reader(input);
+    Dict root;
+    std::optional<ArenaDocument> requests_document;
+    reader.BeginObject();
+    for (std::string key; reader.NextKey(key);) {
+        if (key == "stat_requests"s) {
+            requests_document.emplace(reader.ReadArenaDocument());
+        }
+        else {
+            root.emplace(std::move(key), reader.ReadNode());
+        }
     }
-    Transport_router transport_router(catalogue, routing_settings);
+    serialization::TransportBase base;
+    serialization::LoadBase(ReadSerializationFile(root), base);
+    AnswerRequests(ReadStatRequests(requests_document), base.catalogue, base.render_settings, base.routing_settings
+        , *base.router, ReadThreadCount(root), ReadMetricsReport(root));
+}
 
-    if (const auto& stat_requests = root.find("stat_requests"s); stat_requests != root.end()) {
-        const Array& arr = stat_requests->second.AsArray();
-        if (!arr.empty()) {
-            PrintStat(arr, catalogue, render_settings, routing_settings, transport_router);
+// Разбирает одну строку построчного протокола: объект с массивом stat_requests
+// или управляющей командой в поле command. Запросы ссылаются на арену,
+// поэтому документ живёт, пока на них отвечают
+static std::vector<StatRequest> ReadBatch(std::string_view line, std::optional<ArenaDocument>& requests_document
+    , std::string& command) {
+    Reader reader(line);
+    reader.BeginObject();
+    for (std::string key; reader.NextKey(key);) {
+        if (key == "stat_requests"s) {
+            requests_document.emplace(reader.ReadArenaDocument());
+        }
+        else if (key == "command"s) {
+            command = reader.ReadNode().AsString();
+        }
+        else {
+            reader.ReadNode();
         }
     }
+    return ReadStatRequests(requests_document);
+}
+
+// Ошибки разбора JSON приходят без текста: для них пишется общее сообщение
+static void WriteErrorLine(std::ostream& output, std::string_view message) {
+    Writer(output, 0, Writer::Format::COMPACT)
+        .StartDict()
+        .Key("error_message"sv).Value(message.empty() ? "Malformed request batch"sv : message)
+        .EndDict();
+    output << std::endl;
+}
+
+void ServeRequests(std::istream& settings, std::istream& batches, std::ostream& output) {
+    Reader reader(settings);
+    Dict root;
+    serialization::TransportBase base;
+    bool has_base_requests = false;
+    reader.BeginObject();
+    for (std::string key; reader.NextKey(key);) {
+        if (key == "base_requests"s) {
+            LoadBaseRequests(reader, base.catalogue);
+            has_base_requests = true;
+        }
+        else {
+            root.emplace(std::move(key), reader.ReadNode());
+        }
+    }
+    const size_t thread_count = ReadThreadCount(root);
+    if (has_base_requests) {
+        base.render_settings = ReadRenderSettings(root);
+        base.routing_settings = ReadRoutingSettings(root);
+        base.router.emplace(base.catalogue, base.routing_settings, thread_count);
+    }
+    else {
+        serialization::LoadBase(ReadSerializationFile(root), base);
+    }
+
+    // Карта отрисовывается при первом запросе Map и дальше берётся из кэша
+    const MapCache map_cache(base.catalogue, base.render_settings);
+    const StatContext context{ base.catalogue, map_cache, base.routing_settings, *base.router };
+    const std::string metrics_report = ReadMetricsReport(root);
+    std::optional<metrics::RequestMetrics> request_metrics;
+    if (!metrics_report.empty()) {
+        request_metrics.emplace();
+    }
+
+    // Каждая непустая строка — пакет запросов, ответ на него — одна строка с массивом ответов.
+    // Ошибка в пакете не останавливает сервер: вместо ответов пишется error_message
+    for (std::string line; std::getline(batches, line);) {
+        if (line.find_first_not_of(" \t\r"sv) == std::string::npos) {
+            continue;
+        }
+        TRACE_SCOPE("ServeBatch");
+        std::optional<ArenaDocument> requests_document;
+        std::vector<StatRequest> stat_requests;
+        std::string command;
+        try {
+            stat_requests = ReadBatch(line, requests_document, command);
+        }
+        catch (const std::exception& e) {
+            WriteErrorLine(output, e.what());
+            continue;
+        }
+        // {"command": "metrics"} — текущий отчёт о задержках одной строкой, не дожидаясь конца ввода
+        if (command == "metrics"s) {
+            if (!request_metrics) {
+                WriteErrorLine(output, "Metrics are disabled: set execution_settings.metrics_report"sv);
+                continue;
+            }
+            request_metrics->WriteReport(output, Writer::Format::COMPACT);
+            output << std::endl;
+            continue;
+        }
+        if (!command.empty()) {
+            WriteErrorLine(output, "Unknown command "s + command);
+            continue;
+        }
+        // Ответ собирается целиком, прежде чем попасть в output: если на каком-то запросе
+        // вылетит исключение, клиент получит строку с ошибкой, а не обрывок массива
+        std::ostringstream answers;
+        answers.precision(output.precision());
+        try {
+            PrintStat(stat_requests, context, thread_count, request_metrics ? &*request_metrics : nullptr
+                , answers, Writer::Format::COMPACT);
+        }
+        catch (const std::exception& e) {
+            WriteErrorLine(output, e.what());
+            continue;
+        }
+        // Ответ сбрасывается сразу: клиент ждёт его, прежде чем прислать следующий пакет
+        output << answers.str() << std::endl;
+    }
+    if (request_metrics) {
+        metrics::WriteReport(*request_metrics, metrics_report);
+    }
 }
@@ -9,4 +9,21 @@ using TrCatalogue = transport::core::TransportCatalogue;
 
 json::Document LoadJSON(std::istream& input);
 
-void ParseJson(const json::Document& document, TrCatalogue& catalogue);
\ No newline at end of file
+void ParseJson(const json::Document& document, TrCatalogue& catalogue);
+
+// Разбирает входной JSON потоково: base_requests сразу загружаются в каталог,
+// не превращаясь в дерево json::Node
+void ParseJson(std::istream& input, TrCatalogue& catalogue);
+
+// Первая фаза: загружает base_requests и настройки и сохраняет снимок базы
+// в файл serialization_settings.file
+void MakeBase(std::istream& input);
+
+// Вторая фаза: загружает снимок из serialization_settings.file и отвечает на stat_requests
+void ProcessRequests(std::istream& input);
+
+// Серверный режим: один раз загружает базу по settings (снимок из serialization_settings.file
+// или base_requests) и затем отвечает на пакеты из batches — по одному JSON-объекту
+// со stat_requests в строке. Ответ на пакет — одна строка в output с массивом ответов.
+// Строка {"command": "metrics"} вместо пакета возвращает текущий отчёт о задержках
+void ServeRequests(std::istream& settings, std::istream& batches, std::ostream& output);
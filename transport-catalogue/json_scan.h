@@ -0,0 +1,97 @@
+#pragma once
+
+#include "json.h"
+
+#include <cctype>
+#include <string>
+#include <string_view>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Низкоуровневые функции разбора JSON из непрерывного буфера [pos, end).
+// Общие для json::Load (дерево Node) и json::ArenaDocument
+namespace json::detail {
+
+    inline bool IsSpace(char ch) {
+        return ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t' || ch == '\v' || ch == '\f';
+    }
+
+    inline bool IsDigit(char ch) {
+        return ch >= '0' && ch <= '9';
+    }
+
+    // Возвращает указатель на первый непробельный символ в [pos, end)
+    inline const char* SkipSpaces(const char* pos, const char* end) {
+#ifdef __SSE2__
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i tab = _mm_set1_epi8('\t');
+        const __m128i cr = _mm_set1_epi8('\r');
+        const __m128i lf = _mm_set1_epi8('\n');
+        while (end - pos >= 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+            const __m128i spaces = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, lf)));
+            const unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(spaces)) & 0xFFFFu;
+            if (mask != 0) {
+                pos += __builtin_ctz(mask);
+                break;
+            }
+            pos += 16;
+        }
+#endif
+        while (pos != end && IsSpace(*pos)) {
+            ++pos;
+        }
+        return pos;
+    }
+
+    // Возвращает указатель на первую кавычку, обратную косую черту или перевод строки в [pos, end)
+    inline const char* FindStringSpecial(const char* pos, const char* end) {
+#ifdef __SSE2__
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i cr = _mm_set1_epi8('\r');
+        const __m128i lf = _mm_set1_epi8('\n');
+        while (end - pos >= 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+            const __m128i special = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, lf)));
+            const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+            if (mask != 0) {
+                return pos + __builtin_ctz(mask);
+            }
+            pos += 16;
+        }
+#endif
+        while (pos != end && *pos != '"' && *pos != '\\' && *pos != '\n' && *pos != '\r') {
+            ++pos;
+        }
+        return pos;
+    }
+
+    // Считывает литерал из латинских букв (null, true, false)
+    inline std::string_view ScanLiteral(const char*& pos, const char* end) {
+        const char* start = pos;
+        while (pos != end && std::isalpha(static_cast<unsigned char>(*pos))) {
+            ++pos;
+        }
+        return { start, static_cast<size_t>(pos - start) };
+    }
+
+    // Считывает содержимое строкового литерала в out, pos должен указывать
+    // на символ сразу после открывающей кавычки. После чтения pos указывает за закрывающую кавычку
+    void ScanString(const char*& pos, const char* end, std::string& out);
+
+    struct NumberToken {
+        bool is_int = true;
+        int int_value = 0;
+        double double_value = 0.0;
+    };
+
+    // Считывает число. Целые, не помещающиеся в int, возвращаются как double
+    NumberToken ScanNumber(const char*& pos, const char* end);
+
+}  // namespace json::detail
@@ -0,0 +1,248 @@
+#include "json_writer.h"
+
+#include <charconv>
+#include <cstdio>
+#include <stdexcept>
+
+using namespace std;
+
+namespace json {
+
+    Writer::Writer(std::ostream& output)
+        : output_(output) {
+    }
+
+    Writer::Writer(std::ostream& output, size_t base_depth)
+        : output_(output)
+        , base_depth_(base_depth) {
+    }
+
+    Writer::Writer(std::ostream& output, size_t base_depth, Format format)
+        : output_(output)
+        , base_depth_(base_depth)
+        , format_(format) {
+    }
+
+    Writer::~Writer() {
+        Flush();
+    }
+
+    void Writer::Flush() {
+        output_.write(buffer_.data(), static_cast<streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+
+    void Writer::FlushIfFull() {
+        if (buffer_.size() >= FLUSH_THRESHOLD) {
+            Flush();
+        }
+    }
+
+    // В компактном формате переводы строк и отступы не пишутся
+    void Writer::WriteNewLine() {
+        if (format_ == Format::PRETTY) {
+            buffer_ += '\n';
+        }
+    }
+
+    void Writer::WriteIndent(size_t depth) {
+        if (format_ == Format::COMPACT) {
+            return;
+        }
+        buffer_.append((base_depth_ + depth) * INDENT_STEP, ' ');
+    }
+
+    // Пишет разделитель и отступ перед очередным значением массива.
+    // Значение словаря уже предварено ключом
+    void Writer::BeginValue() {
+        if (after_key_) {
+            after_key_ = false;
+            return;
+        }
+        if (levels_.empty()) {
+            return;
+        }
+        Level& level = levels_.back();
+        if (level.is_dict) {
+            throw logic_error("Key is expected");
+        }
+        if (!level.empty) {
+            buffer_ += ',';
+            WriteNewLine();
+        }
+        level.empty = false;
+        WriteIndent(levels_.size());
+    }
+
+    void Writer::Start(bool is_dict, char bracket) {
+        BeginValue();
+        buffer_ += bracket;
+        WriteNewLine();
+        levels_.push_back({ is_dict, true });
+    }
+
+    void Writer::End(bool is_dict, char bracket) {
+        if (levels_.empty() || levels_.back().is_dict != is_dict || after_key_) {
+            throw logic_error("Unexpected end of container");
+        }
+        levels_.pop_back();
+        WriteNewLine();
+        WriteIndent(levels_.size());
+        buffer_ += bracket;
+        FlushIfFull();
+    }
+
+    Writer& Writer::StartArray() {
+        Start(false, '[');
+        return *this;
+    }
+
+    Writer& Writer::EndArray() {
+        End(false, ']');
+        return *this;
+    }
+
+    Writer& Writer::StartDict() {
+        Start(true, '{');
+        return *this;
+    }
+
+    Writer& Writer::EndDict() {
+        End(true, '}');
+        return *this;
+    }
+
+    Writer& Writer::Key(std::string_view key) {
+        if (levels_.empty() || !levels_.back().is_dict || after_key_) {
+            throw logic_error("Key is not expected");
+        }
+        Level& level = levels_.back();
+        if (!level.empty) {
+            buffer_ += ',';
+            WriteNewLine();
+        }
+        level.empty = false;
+        WriteIndent(levels_.size());
+        WriteString(key);
+        buffer_ += format_ == Format::PRETTY ? ": "sv : ":"sv;
+        after_key_ = true;
+        return *this;
+    }
+
+    Writer& Writer::Value(const Node& node) {
+        if (node.IsArray()) {
+            StartArray();
+            for (const Node& element : node.AsArray()) {
+                Value(element);
+            }
+            return EndArray();
+        }
+        if (node.IsMap()) {
+            StartDict();
+            for (const auto& [key, value] : node.AsMap()) {
+                Key(key).Value(value);
+            }
+            return EndDict();
+        }
+        if (node.IsBool()) {
+            return Value(node.AsBool());
+        }
+        if (node.IsInt()) {
+            return Value(node.AsInt());
+        }
+        if (node.IsPureDouble()) {
+            return Value(node.AsDouble());
+        }
+        if (node.IsString()) {
+            return Value(std::string_view(node.AsString()));
+        }
+        return Value(nullptr);
+    }
+
+    Writer& Writer::Value(std::nullptr_t) {
+        BeginValue();
+        buffer_ += "null"sv;
+        FlushIfFull();
+        return *this;
+    }
+
+    Writer& Writer::Value(bool value) {
+        BeginValue();
+        buffer_ += value ? "true"sv : "false"sv;
+        FlushIfFull();
+        return *this;
+    }
+
+    Writer& Writer::Value(int value) {
+        BeginValue();
+        char chars[16];
+        const auto result = to_chars(begin(chars), end(chars), value);
+        buffer_.append(chars, result.ptr);
+        FlushIfFull();
+        return *this;
+    }
+
+    Writer& Writer::Value(uint64_t value) {
+        BeginValue();
+        char chars[24];
+        const auto result = to_chars(begin(chars), end(chars), value);
+        buffer_.append(chars, result.ptr);
+        FlushIfFull();
+        return *this;
+    }
+
+    // Формат совпадает с operator<< потока без флагов: %g с точностью потока
+    Writer& Writer::Value(double value) {
+        BeginValue();
+        char chars[64];
+        const int size = snprintf(chars, sizeof(chars), "%.*g", static_cast<int>(output_.precision()), value);
+        buffer_.append(chars, static_cast<size_t>(size));
+        FlushIfFull();
+        return *this;
+    }
+
+    Writer& Writer::Value(std::string_view value) {
+        BeginValue();
+        WriteString(value);
+        FlushIfFull();
+        return *this;
+    }
+
+    Writer& Writer::Value(const char* value) {
+        return Value(std::string_view(value));
+    }
+
+    Writer& Writer::FormattedValue(std::string_view formatted) {
+        BeginValue();
+        buffer_ += formatted;
+        FlushIfFull();
+        return *this;
+    }
+
+    void Writer::WriteString(std::string_view str) {
+        buffer_ += '"';
+        for (const char ch : str) {
+            switch (ch) {
+            case '\r':
+                buffer_ += "\\r"sv;
+                break;
+            case '\n':
+                buffer_ += "\\n"sv;
+                break;
+            case '\t':
+                buffer_ += "\\t"sv;
+                break;
+            case '"':
+                buffer_ += "\\\""sv;
+                break;
+            case '\\':
+                buffer_ += "\\\\"sv;
+                break;
+            default:
+                buffer_ += ch;
+            }
+        }
+        buffer_ += '"';
+    }
+
+}  // namespace json
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "json.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace json {
+
+    /*
+     * Потоковая запись JSON в том же формате, что и json::Print.
+     * Значения сразу форматируются во внутренний буфер, который сбрасывается
+     * в поток по мере заполнения, так что документ целиком в памяти не хранится
+     */
+    class Writer {
+    public:
+        // PRETTY — формат json::Print с отступами, COMPACT — весь документ в одну строку
+        // без пробелов, как нужно для ответов построчного протокола
+        enum class Format {
+            PRETTY,
+            COMPACT,
+        };
+
+        explicit Writer(std::ostream& output);
+        // Пишет значения так, будто они вложены в base_depth уровней массивов:
+        // так можно отформатировать элемент в отдельном потоке и потом вставить
+        // его в основной документ через FormattedValue
+        Writer(std::ostream& output, size_t base_depth);
+        Writer(std::ostream& output, size_t base_depth, Format format);
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+        ~Writer();
+
+        Writer& StartArray();
+        Writer& EndArray();
+        Writer& StartDict();
+        Writer& EndDict();
+        Writer& Key(std::string_view key);
+
+        Writer& Value(const Node& node);
+        Writer& Value(std::nullptr_t);
+        Writer& Value(bool value);
+        Writer& Value(int value);
+        Writer& Value(uint64_t value);
+        Writer& Value(double value);
+        Writer& Value(std::string_view value);
+        Writer& Value(const char* value);
+        // Вставляет значение, уже отформатированное Writer с подходящей base_depth
+        Writer& FormattedValue(std::string_view formatted);
+
+        // Сбрасывает накопленный буфер в поток
+        void Flush();
+
+    private:
+        static constexpr size_t FLUSH_THRESHOLD = 1 << 16;
+        static constexpr int INDENT_STEP = 4;
+
+        struct Level {
+            bool is_dict = false;
+            bool empty = true;
+        };
+
+        std::ostream& output_;
+        std::string buffer_;
+        std::vector<Level> levels_;
+        size_t base_depth_ = 0;
+        Format format_ = Format::PRETTY;
+        bool after_key_ = false;
+
+        void BeginValue();
+        void Start(bool is_dict, char bracket);
+        void End(bool is_dict, char bracket);
+        void WriteNewLine();
+        void WriteIndent(size_t depth);
+        void WriteString(std::string_view str);
+        void FlushIfFull();
+    };
+
+}  // namespace json
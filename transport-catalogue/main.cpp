@@ -1,9 +1,58 @@
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include "json_reader.h"
+#include "trace.h"
 using namespace std;
 
-int main() {
-    transport::core::TransportCatalogue catalogue; 
-    ParseJson(LoadJSON(cin), catalogue); 
+void PrintUsage(std::ostream& stream = std::cerr) {
+    stream << "Usage: transport_catalogue [make_base|process_requests]\n"sv
+           << "       transport_catalogue serve <settings.json>\n"sv;
+}
+
+int main(int argc, char* argv[]) {
+    TRACE_SESSION();
+    // Без аргументов база и запросы читаются из одного JSON за один запуск
+    if (argc == 1) {
+        transport::core::TransportCatalogue catalogue; 
+        ParseJson(cin, catalogue); 
+        return 0;
+    }
+    if (argc != 2 && argc != 3) {
+        PrintUsage();
+        return 1;
+    }
 
+    const std::string_view mode(argv[1]);
+    try {
+        if (argc == 3) {
+            // База загружается один раз, а пакеты запросов читаются построчно из stdin
+            if (mode != "serve"sv) {
+                PrintUsage();
+                return 1;
+            }
+            std::ifstream settings(argv[2]);
+            if (!settings) {
+                throw std::runtime_error("Can't open settings file "s + argv[2]);
+            }
+            ServeRequests(settings, cin, cout);
+        }
+        else if (mode == "make_base"sv) {
+            MakeBase(cin);
+        }
+        else if (mode == "process_requests"sv) {
+            ProcessRequests(cin);
+        }
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    catch (const std::exception& e) {
+        // Чаще всего это отсутствующий или повреждённый файл снимка
+        cerr << e.what() << endl;
+        return 1;
+    }
 }
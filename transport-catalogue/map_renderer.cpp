@@ -1,40 +1,55 @@
 #include "map_renderer.h"
+#include "trace.h"
 
-#include <sstream>
 
-
-std::deque<geo::Coordinates> MapRenderer::FillCoordinstes(const std::deque<Stop>& stops_) {
-    std::deque<geo::Coordinates> coordinates;
-    for (auto& stop : stops_) {
-        if (0 == std::count_if(routes_.begin(), routes_.end(), [&stop](const Route& route) {
-            return std::find(route.stops.begin(), route.stops.end(), stop.name) != route.stops.end(); })) {
-            continue;
+// Отмечает обслуживаемые остановки в битовой карте по Stop::idx: O(S + сумма длин маршрутов)
+std::vector<const Stop*> MapRenderer::CollectServedStops() const {
+    size_t stop_count = 0;
+    for (const Stop& stop : stops_) {
+        stop_count = std::max(stop_count, stop.idx + 1);
+    }
+    std::vector<bool> served(stop_count, false);
+    for (const Route& route : routes_) {
+        for (uint32_t stop : route.stops) {
+            served[stop] = true;
+        }
+    }
+    std::vector<const Stop*> served_stops;
+    for (const Stop& stop : stops_) {
+        if (served[stop.idx]) {
+            served_stops.push_back(&stop);
         }
-        coordinates.push_back(stop.coordinates);
     }
-    return coordinates;
+    return served_stops;
 }
 
-const geo::Coordinates& MapRenderer::FindCoordinatesOfName(const std::string_view name){
-    return (*std::find_if(stops_.begin(), stops_.end(), [&](const Stop& stop) {return stop.name == name;})).coordinates;
+SphereProjector MapRenderer::MakeProjector() const {
+    std::vector<geo::Coordinates> coordinates;
+    coordinates.reserve(served_stops_.size());
+    for (const Stop* stop : served_stops_) {
+        coordinates.push_back(stop->coordinates);
+    }
+    return SphereProjector(coordinates.begin(), coordinates.end(), render_settings_.width, render_settings_.height, render_settings_.padding);
 }
 
-const std::string& MapRenderer::FindStopOfCoordinates(const geo::Coordinates& coordinates){
-    return (*std::find_if(stops_.begin(), stops_.end(), [&](const Stop& stop) {return stop.coordinates == coordinates; })).name;
+void MapRenderer::ProjectServedStops() {
+    size_t stop_count = 0;
+    for (const Stop* stop : served_stops_) {
+        stop_count = std::max(stop_count, stop->idx + 1);
+    }
+    stop_points_.resize(stop_count);
+    for (const Stop* stop : served_stops_) {
+        stop_points_[stop->idx] = sphereProjector_(stop->coordinates);
+    }
 }
 
 const svg::Polyline MapRenderer::RenderPoliline(const Route& route, const int& id) {
-
-    std::deque<svg::Point> stops_points;
-    for (std::string_view stop : route.stops) {
-        stops_points.push_back(sphereProjector_(FindCoordinatesOfName(stop)));
-    }
     svg::Polyline polyline;
     polyline.SetFillColor(svg::NoneColor).SetStrokeColor(render_settings_.color_palette[id])
         .SetStrokeWidth(render_settings_.line_width).SetStrokeLineCap(svg::StrokeLineCap::ROUND)
         .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
-    for (const auto& stop_point : stops_points) {
-        polyline.AddPoint(stop_point);
+    for (uint32_t stop : route.stops) {
+        polyline.AddPoint(stop_points_[stop]);
     }
     return polyline;
 }
@@ -56,23 +71,23 @@ const svg::Text MapRenderer::RenderRouteName(const std::string& text, const svg:
         .SetFontFamily("Verdana").SetFontWeight("bold");
     return route_name;
 }
-const svg::Circle MapRenderer::RenderStopPoint(const geo::Coordinates& point) {
+const svg::Circle MapRenderer::RenderStopPoint(const Stop& stop) {
     svg::Circle circle;
-    circle.SetCenter(sphereProjector_(point)).SetRadius(render_settings_.stop_radius).SetFillColor("white"s);
+    circle.SetCenter(stop_points_[stop.idx]).SetRadius(render_settings_.stop_radius).SetFillColor("white"s);
     return circle;
 }
-const svg::Text MapRenderer::RenderStopNameUnderLayer(const geo::Coordinates& point) {
+const svg::Text MapRenderer::RenderStopNameUnderLayer(const Stop& stop) {
     svg::Text underlayer;
-    underlayer.SetData(FindStopOfCoordinates(point)).SetPosition(sphereProjector_(point))
+    underlayer.SetData(stop.name).SetPosition(stop_points_[stop.idx])
         .SetFillColor(render_settings_.underlayer_color).SetStrokeColor(render_settings_.underlayer_color)
         .SetStrokeWidth(render_settings_.underlayer_width).SetStrokeLineCap(svg::StrokeLineCap::ROUND)
         .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND).SetOffset({ render_settings_.stop_label_offset.dx, render_settings_.stop_label_offset.dy })
         .SetFontSize(static_cast<uint32_t>(render_settings_.stop_label_font_size)).SetFontFamily("Verdana");
     return underlayer;
 }
-const svg::Text MapRenderer::RenderStopName(const geo::Coordinates& point) {
+const svg::Text MapRenderer::RenderStopName(const Stop& stop) {
     svg::Text route_name;
-    route_name.SetData(FindStopOfCoordinates(point)).SetPosition(sphereProjector_(point)).SetFillColor("black"s)
+    route_name.SetData(stop.name).SetPosition(stop_points_[stop.idx]).SetFillColor("black"s)
         .SetOffset({ render_settings_.stop_label_offset.dx, render_settings_.stop_label_offset.dy })
         .SetFontSize(static_cast<uint32_t>(render_settings_.stop_label_font_size)).SetFontFamily("Verdana");
     return route_name;
@@ -87,26 +102,40 @@ void MapRenderer::RenderMap() {
     }
     id = 0;
     for (const auto& route : routes_) {
-        result.Add(RenderRouteNameUnderLayer(route.name, sphereProjector_(FindCoordinatesOfName(route.stops.front()))));
-        result.Add(RenderRouteName(route.name, sphereProjector_(FindCoordinatesOfName(route.stops.front())), id));
+        result.Add(RenderRouteNameUnderLayer(route.name, stop_points_[route.stops.front()]));
+        result.Add(RenderRouteName(route.name, stop_points_[route.stops.front()], id));
         if (route.stops.front()!=route.last_stop) {
-            result.Add(RenderRouteNameUnderLayer(route.name, sphereProjector_(FindCoordinatesOfName(route.last_stop))));
-            result.Add(RenderRouteName(route.name, sphereProjector_(FindCoordinatesOfName(route.last_stop)), id));
+            result.Add(RenderRouteNameUnderLayer(route.name, stop_points_[route.last_stop]));
+            result.Add(RenderRouteName(route.name, stop_points_[route.last_stop], id));
         }
         id + 1 < render_settings_.color_palette.size() ? id++ : id = 0;
     }
-    for (const auto& point : coordinates_) {
-        result.Add(RenderStopPoint(point));
+    for (const Stop* stop : served_stops_) {
+        result.Add(RenderStopPoint(*stop));
     }
-    for (const auto& point : coordinates_) {
-        result.Add(RenderStopNameUnderLayer(point));
-        result.Add(RenderStopName(point));
+    for (const Stop* stop : served_stops_) {
+        result.Add(RenderStopNameUnderLayer(*stop));
+        result.Add(RenderStopName(*stop));
     }
-    std::ostringstream result_str;
-    result.Render(result_str);
-    map_ = result_str.str();
+    map_.clear();
+    result.Render(map_);
+}
+
+const std::string& MapRenderer::GetMap() const& {
+    return map_;
 }
 
-const std::string MapRenderer::GetMap() const{
+std::string MapRenderer::GetMap()&& {
+    return std::move(map_);
+}
+
+std::shared_ptr<const std::string> MapCache::Get() const {
+    std::lock_guard guard(mutex_);
+    if (!map_ || version_ != catalogue_.GetVersion()) {
+        TRACE_SCOPE("MapRenderer");
+        MapRenderer renderer(render_settings_, catalogue_.GetSortedRoutes(), catalogue_.GetSortedStops());
+        map_ = std::make_shared<const std::string>(std::move(renderer).GetMap());
+        version_ = catalogue_.GetVersion();
+    }
     return map_;
-}
\ No newline at end of file
+}
@@ -6,9 +6,13 @@
 #include <algorithm>
 #include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <deque>
+#include <vector>
 #include "domain.h"
+#include "transport_catalogue.h"
 
 inline const double EPSILON = 1e-6;
 
@@ -108,34 +112,59 @@ class MapRenderer {
 public:
     MapRenderer(const RenderSettings& render_settings, std::deque<Route> routes, std::deque<Stop> stops) :
         render_settings_(render_settings), routes_(std::move(routes)), stops_(std::move(stops))
-        , coordinates_(std::move(FillCoordinstes(stops_)))
-        , sphereProjector_(SphereProjector(coordinates_.begin(), coordinates_.end(), render_settings_.width, render_settings_.height, render_settings_.padding)) {
+        , served_stops_(CollectServedStops())
+        , sphereProjector_(MakeProjector()) {
+        ProjectServedStops();
         RenderMap();
     }
 
-    const std::string GetMap() const ;
+    const std::string& GetMap() const&;
+    // Отдаёт готовую SVG без копирования, если рендерер больше не нужен
+    std::string GetMap()&&;
 private:
     const RenderSettings& render_settings_;
     const std::deque<Route> routes_;
     const std::deque<Stop> stops_;
-    const std::deque<geo::Coordinates> coordinates_;
+    // Остановки, через которые проходит хотя бы один маршрут, в порядке имён
+    const std::vector<const Stop*> served_stops_;
     const SphereProjector sphereProjector_;
+    // Точка на карте для каждой обслуживаемой остановки (по Stop::idx)
+    std::vector<svg::Point> stop_points_;
     std::string map_;
 
     void RenderMap();
 
-    std::deque<geo::Coordinates> FillCoordinstes(const std::deque<Stop>& stops_);
-
-    const geo::Coordinates& FindCoordinatesOfName(const std::string_view name);
-    const std::string& FindStopOfCoordinates(const geo::Coordinates& coordinates);
+    std::vector<const Stop*> CollectServedStops() const;
+    SphereProjector MakeProjector() const;
+    void ProjectServedStops();
 
     const svg::Polyline RenderPoliline(const Route& route, const int& id);
     const svg::Text RenderRouteNameUnderLayer(const std::string& text, const svg::Point& point);
     const svg::Text RenderRouteName(const std::string& text, const svg::Point& point, const int& id);
-    const svg::Circle RenderStopPoint(const geo::Coordinates& point);
-    const svg::Text RenderStopNameUnderLayer(const geo::Coordinates& point);
-    const svg::Text RenderStopName(const geo::Coordinates& point);
+    const svg::Circle RenderStopPoint(const Stop& stop);
+    const svg::Text RenderStopNameUnderLayer(const Stop& stop);
+    const svg::Text RenderStopName(const Stop& stop);
 };
 
+/*
+ * Карта, отрисованная для одного состояния каталога и одних настроек.
+ * Рисуется при первом запросе и заново — только если каталог изменился,
+ * все остальные запросы получают один и тот же неизменяемый буфер.
+ * Get можно вызывать из нескольких потоков
+ */
+class MapCache {
+public:
+    MapCache(const transport::core::TransportCatalogue& catalogue, const RenderSettings& render_settings)
+        : catalogue_(catalogue)
+        , render_settings_(render_settings) {
+    }
 
+    std::shared_ptr<const std::string> Get() const;
 
+private:
+    const transport::core::TransportCatalogue& catalogue_;
+    const RenderSettings& render_settings_;
+    mutable std::mutex mutex_;
+    mutable std::shared_ptr<const std::string> map_;
+    mutable uint64_t version_ = 0;
+};
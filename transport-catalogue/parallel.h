@@ -0,0 +1,317 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace parallel {
+
+// Число потоков по умолчанию: 0 означает «по числу ядер»
+inline size_t ResolveThreadCount(size_t requested) {
+    if (requested != 0) {
+        return requested;
+    }
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+/*
+ * Потоки, которые живут до конца программы: ForEachChunk и OrderedForEachChunk
+ * отдают им задачи, а не запускают и не дожидаются новые std::thread на каждый вызов.
+ * Пул дорастает до наибольшего запрошенного числа потоков и не уменьшается
+ */
+class ThreadPool {
+public:
+    ThreadPool() = default;
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool() {
+        {
+            std::lock_guard guard(mutex_);
+            stopped_ = true;
+        }
+        changed_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    /*
+     * Выполняет task в worker_count потоках пула и in_caller в вызывающем потоке
+     * и возвращается, когда завершатся все. task не должен бросать исключений,
+     * исключение из in_caller пробрасывается после завершения задач.
+     * Задачу, которую ещё не взял ни один поток пула, выполняет сам ожидающий поток,
+     * поэтому вызов из задачи пула не ждёт освобождения занятых потоков
+     */
+    template <typename Task, typename InCaller>
+    void Run(size_t worker_count, Task& task, InCaller&& in_caller) {
+        size_t remaining = worker_count;
+        {
+            std::lock_guard guard(mutex_);
+            try {
+                while (workers_.size() < worker_count) {
+                    workers_.emplace_back([this] {
+                        WorkerLoop();
+                    });
+                }
+            }
+            catch (const std::system_error&) {
+                // Задачи, которым не хватило потоков, выполнит ожидающий поток
+            }
+            for (size_t i = 0; i < worker_count; ++i) {
+                queue_.push_back({ [&task] { task(); }, &remaining });
+            }
+        }
+        changed_.notify_all();
+
+        std::exception_ptr error;
+        try {
+            in_caller();
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        Wait(remaining);
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    size_t GetThreadCount() const {
+        std::lock_guard guard(mutex_);
+        return workers_.size();
+    }
+
+private:
+    struct QueuedTask {
+        std::function<void()> task;
+        // Счётчик незавершённых задач вызова Run, которому принадлежит задача
+        size_t* remaining;
+    };
+
+    void WorkerLoop() {
+        std::unique_lock lock(mutex_);
+        while (true) {
+            changed_.wait(lock, [this] {
+                return stopped_ || !queue_.empty();
+            });
+            if (queue_.empty()) {
+                return;
+            }
+            QueuedTask queued = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+            queued.task();
+            lock.lock();
+            --*queued.remaining;
+            changed_.notify_all();
+        }
+    }
+
+    void Wait(size_t& remaining) {
+        std::unique_lock lock(mutex_);
+        while (remaining > 0) {
+            const auto own = std::find_if(queue_.begin(), queue_.end(), [&remaining](const QueuedTask& queued) {
+                return queued.remaining == &remaining;
+            });
+            if (own == queue_.end()) {
+                changed_.wait(lock);
+                continue;
+            }
+            QueuedTask queued = std::move(*own);
+            queue_.erase(own);
+            lock.unlock();
+            queued.task();
+            lock.lock();
+            --remaining;
+        }
+    }
+
+    mutable std::mutex mutex_;
+    // Сообщает и о новых задачах, и о завершённых
+    std::condition_variable changed_;
+    std::deque<QueuedTask> queue_;
+    std::vector<std::thread> workers_;
+    bool stopped_ = false;
+};
+
+// Общий пул для ForEachChunk и OrderedForEachChunk
+inline ThreadPool& GetSharedPool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+/*
+ * Вызывает func(begin, end) для блоков по chunk_size элементов диапазона [0, count)
+ * в thread_count потоках, включая вызывающий; остальные берутся из GetSharedPool().
+ * Порядок обработки блоков не гарантируется: свободный поток забирает следующий необработанный блок.
+ * Первое исключение из func прекращает раздачу блоков и пробрасывается наружу
+ */
+template <typename Func>
+void ForEachChunk(size_t count, size_t chunk_size, size_t thread_count, Func func) {
+    chunk_size = std::max<size_t>(chunk_size, 1);
+    const size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+    thread_count = std::min(std::max<size_t>(thread_count, 1), chunk_count);
+    if (thread_count <= 1) {
+        for (size_t begin = 0; begin < count; begin += chunk_size) {
+            func(begin, std::min(begin + chunk_size, count));
+        }
+        return;
+    }
+
+    std::atomic<size_t> next_chunk = 0;
+    std::mutex mutex;
+    std::exception_ptr error;
+    auto work = [&] {
+        while (true) {
+            const size_t chunk = next_chunk.fetch_add(1);
+            if (chunk >= chunk_count) {
+                return;
+            }
+            const size_t begin = chunk * chunk_size;
+            try {
+                func(begin, std::min(begin + chunk_size, count));
+            }
+            catch (...) {
+                std::lock_guard guard(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next_chunk = chunk_count;
+                return;
+            }
+        }
+    };
+
+    GetSharedPool().Run(thread_count - 1, work, work);
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/*
+ * Делит диапазон [0, count) на блоки по chunk_size элементов и обрабатывает их
+ * в thread_count потоках GetSharedPool(): produce(begin, end) вызывается в рабочих потоках,
+ * consume(result) — в вызывающем потоке строго в порядке блоков. Если очередной блок
+ * ещё не взял ни один рабочий поток, вызывающий поток считает его сам.
+ * Свободный поток забирает следующий необработанный блок, поэтому медленные блоки
+ * не задерживают остальные потоки. Чтобы готовые результаты не копились без предела,
+ * рабочие потоки опережают consume не более чем на max_chunks_ahead блоков.
+ * Исключение из produce или consume прекращает обработку и пробрасывается наружу
+ */
+template <typename Produce, typename Consume>
+void OrderedForEachChunk(size_t count, size_t chunk_size, size_t thread_count,
+                         Produce produce, Consume consume, size_t max_chunks_ahead = 64) {
+    using Result = std::invoke_result_t<Produce&, size_t, size_t>;
+
+    chunk_size = std::max<size_t>(chunk_size, 1);
+    const size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+    thread_count = std::min(std::max<size_t>(thread_count, 1), chunk_count);
+    if (thread_count <= 1) {
+        for (size_t begin = 0; begin < count; begin += chunk_size) {
+            consume(produce(begin, std::min(begin + chunk_size, count)));
+        }
+        return;
+    }
+    max_chunks_ahead = std::max(max_chunks_ahead, thread_count);
+
+    struct Slot {
+        std::optional<Result> result;
+        std::exception_ptr error;
+        bool ready = false;
+    };
+    std::vector<Slot> slots(chunk_count);
+    std::mutex mutex;
+    std::condition_variable chunk_ready;
+    std::condition_variable chunk_consumed;
+    size_t next_chunk = 0;
+    size_t consumed = 0;
+    bool stopped = false;
+
+    auto work = [&] {
+        std::unique_lock lock(mutex);
+        while (true) {
+            chunk_consumed.wait(lock, [&] {
+                return stopped || next_chunk == chunk_count || next_chunk < consumed + max_chunks_ahead;
+            });
+            if (stopped || next_chunk == chunk_count) {
+                return;
+            }
+            const size_t chunk = next_chunk++;
+            lock.unlock();
+            const size_t begin = chunk * chunk_size;
+            std::optional<Result> result;
+            std::exception_ptr error;
+            try {
+                result.emplace(produce(begin, std::min(begin + chunk_size, count)));
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            lock.lock();
+            slots[chunk].result = std::move(result);
+            slots[chunk].error = error;
+            slots[chunk].ready = true;
+            chunk_ready.notify_all();
+        }
+    };
+
+    auto stop = [&] {
+        {
+            std::lock_guard guard(mutex);
+            stopped = true;
+        }
+        chunk_consumed.notify_all();
+    };
+    auto consume_all = [&] {
+        try {
+            for (size_t chunk = 0; chunk < chunk_count; ++chunk) {
+                Slot slot;
+                {
+                    std::unique_lock lock(mutex);
+                    chunk_ready.wait(lock, [&] {
+                        return slots[chunk].ready || next_chunk == chunk;
+                    });
+                    if (!slots[chunk].ready) {
+                        ++next_chunk;
+                        lock.unlock();
+                        try {
+                            slot.result.emplace(produce(chunk * chunk_size, std::min((chunk + 1) * chunk_size, count)));
+                        }
+                        catch (...) {
+                            slot.error = std::current_exception();
+                        }
+                    }
+                    else {
+                        slot = std::move(slots[chunk]);
+                    }
+                }
+                if (slot.error) {
+                    std::rethrow_exception(slot.error);
+                }
+                consume(std::move(*slot.result));
+                {
+                    std::lock_guard guard(mutex);
+                    consumed = chunk + 1;
+                }
+                chunk_consumed.notify_all();
+            }
+        }
+        catch (...) {
+            stop();
+            throw;
+        }
+    };
+    GetSharedPool().Run(thread_count, work, consume_all);
+}
+
+}  // namespace parallel
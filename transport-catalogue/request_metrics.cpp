@@ -0,0 +1,158 @@
+#include "request_metrics.h"
+#include "json_writer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace metrics {
+
+    size_t LatencyHistogram::GetBucket(uint64_t value) {
+        if (value < SUB_BUCKET_COUNT) {
+            return static_cast<size_t>(value);
+        }
+        // Октава [2^msb, 2^(msb+1)) делится на SUB_BUCKET_COUNT корзин шириной 2^shift
+        const int msb = 63 - __builtin_clzll(value);
+        const int shift = msb - SUB_BUCKET_BITS;
+        const size_t sub_bucket = static_cast<size_t>(value >> shift) - SUB_BUCKET_COUNT;
+        return SUB_BUCKET_COUNT * static_cast<size_t>(shift + 1) + sub_bucket;
+    }
+
+    uint64_t LatencyHistogram::GetBucketUpperBound(size_t bucket) {
+        if (bucket < SUB_BUCKET_COUNT) {
+            return bucket;
+        }
+        const int shift = static_cast<int>(bucket / SUB_BUCKET_COUNT) - 1;
+        const uint64_t lower = static_cast<uint64_t>(SUB_BUCKET_COUNT + bucket % SUB_BUCKET_COUNT) << shift;
+        return lower + ((uint64_t{ 1 } << shift) - 1);
+    }
+
+    void LatencyHistogram::Record(uint64_t value) {
+        ++counts_[GetBucket(value)];
+        ++count_;
+        max_ = max(max_, value);
+        total_ += static_cast<double>(value);
+    }
+
+    void LatencyHistogram::Merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        max_ = max(max_, other.max_);
+        total_ += other.total_;
+    }
+
+    uint64_t LatencyHistogram::GetCount() const {
+        return count_;
+    }
+
+    uint64_t LatencyHistogram::GetMax() const {
+        return max_;
+    }
+
+    double LatencyHistogram::GetMean() const {
+        return count_ == 0 ? 0.0 : total_ / static_cast<double>(count_);
+    }
+
+    uint64_t LatencyHistogram::GetPercentile(double percentile) const {
+        if (count_ == 0) {
+            return 0;
+        }
+        const double rank = ceil(static_cast<double>(count_) * clamp(percentile, 0.0, 100.0) / 100.0);
+        const uint64_t target = max<uint64_t>(1, static_cast<uint64_t>(rank));
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+            seen += counts_[bucket];
+            if (seen >= target) {
+                // Верхняя граница корзины может превышать реальный максимум
+                return min(GetBucketUpperBound(bucket), max_);
+            }
+        }
+        return max_;
+    }
+
+    optional<RequestType> ParseRequestType(string_view type) {
+        if (type == "Bus"sv) {
+            return RequestType::BUS;
+        }
+        if (type == "Stop"sv) {
+            return RequestType::STOP;
+        }
+        if (type == "Map"sv) {
+            return RequestType::MAP;
+        }
+        if (type == "Route"sv) {
+            return RequestType::ROUTE;
+        }
+        return nullopt;
+    }
+
+    void RequestMetrics::Record(RequestType type, uint64_t nanoseconds, bool error) {
+        TypeMetrics& metrics = types_[static_cast<size_t>(type)];
+        metrics.latency.Record(nanoseconds);
+        metrics.errors += error;
+    }
+
+    void RequestMetrics::Merge(const RequestMetrics& other) {
+        for (size_t i = 0; i < TYPE_COUNT; ++i) {
+            types_[i].latency.Merge(other.types_[i].latency);
+            types_[i].errors += other.types_[i].errors;
+        }
+    }
+
+    namespace {
+        void WriteTypeReport(json::Writer& writer, const LatencyHistogram& latency, uint64_t errors) {
+            auto microseconds = [](double nanoseconds) {
+                return nanoseconds / 1000.0;
+            };
+            writer.StartDict()
+                .Key("count"sv).Value(latency.GetCount())
+                .Key("errors"sv).Value(errors)
+                .Key("latency_us"sv).StartDict()
+                .Key("p50"sv).Value(microseconds(static_cast<double>(latency.GetPercentile(50))))
+                .Key("p99"sv).Value(microseconds(static_cast<double>(latency.GetPercentile(99))))
+                .Key("p999"sv).Value(microseconds(static_cast<double>(latency.GetPercentile(99.9))))
+                .Key("max"sv).Value(microseconds(static_cast<double>(latency.GetMax())))
+                .Key("mean"sv).Value(microseconds(latency.GetMean()))
+                .EndDict()
+                .EndDict();
+        }
+    }
+
+    void RequestMetrics::WriteReport(ostream& output, json::Writer::Format format) const {
+        static constexpr string_view TYPE_NAMES[TYPE_COUNT] = { "Bus"sv, "Stop"sv, "Map"sv, "Route"sv };
+        LatencyHistogram total_latency;
+        uint64_t total_errors = 0;
+        json::Writer writer(output, 0, format);
+        writer.StartDict().Key("stat_requests"sv).StartDict();
+        for (size_t i = 0; i < TYPE_COUNT; ++i) {
+            writer.Key(TYPE_NAMES[i]);
+            WriteTypeReport(writer, types_[i].latency, types_[i].errors);
+            total_latency.Merge(types_[i].latency);
+            total_errors += types_[i].errors;
+        }
+        writer.EndDict().Key("total"sv);
+        WriteTypeReport(writer, total_latency, total_errors);
+        writer.EndDict();
+    }
+
+    void WriteReport(const RequestMetrics& metrics, const string& target) {
+        if (target == "stderr"s) {
+            metrics.WriteReport(cerr);
+            cerr << endl;
+            return;
+        }
+        ofstream output(target);
+        metrics.WriteReport(output);
+        output << '\n';
+        if (!output) {
+            throw runtime_error("Can't write metrics report to "s + target);
+        }
+    }
+
+}  // namespace metrics
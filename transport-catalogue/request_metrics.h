@@ -0,0 +1,83 @@
+#pragma once
+
+#include "json_writer.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace metrics {
+
+    /*
+     * Гистограмма задержек в духе HdrHistogram: значения до 2^SUB_BUCKET_BITS
+     * хранятся точно, а каждая следующая октава [2^m, 2^(m+1)) делится на
+     * SUB_BUCKET_COUNT равных корзин. Относительная погрешность любого перцентиля
+     * не больше 1 / SUB_BUCKET_COUNT, а запись — несколько битовых операций
+     * без выделения памяти
+     */
+    class LatencyHistogram {
+    public:
+        void Record(uint64_t value);
+        void Merge(const LatencyHistogram& other);
+
+        uint64_t GetCount() const;
+        uint64_t GetMax() const;
+        double GetMean() const;
+        // Наименьшее значение, не меньше которого percentile процентов записей
+        // (с точностью до корзины); 0 для пустой гистограммы
+        uint64_t GetPercentile(double percentile) const;
+
+    private:
+        static constexpr int SUB_BUCKET_BITS = 5;
+        static constexpr size_t SUB_BUCKET_COUNT = size_t{ 1 } << SUB_BUCKET_BITS;
+        static constexpr size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+        static size_t GetBucket(uint64_t value);
+        static uint64_t GetBucketUpperBound(size_t bucket);
+
+        std::array<uint64_t, BUCKET_COUNT> counts_{};
+        uint64_t count_ = 0;
+        uint64_t max_ = 0;
+        // Сумма в double: переполнение uint64 наносекундами маловероятно, но возможно
+        double total_ = 0;
+    };
+
+    enum class RequestType {
+        BUS,
+        STOP,
+        MAP,
+        ROUTE,
+    };
+
+    // Тип stat_request по полю "type"; для неизвестных типов — nullopt
+    std::optional<RequestType> ParseRequestType(std::string_view type);
+
+    // Счётчики и задержки ответов на stat_requests по типам запросов.
+    // Не потокобезопасен: каждый поток копит свои метрики, а потом они сливаются через Merge
+    class RequestMetrics {
+    public:
+        void Record(RequestType type, uint64_t nanoseconds, bool error);
+        void Merge(const RequestMetrics& other);
+
+        // JSON-отчёт: для каждого типа и для всех запросов вместе — count, errors
+        // и задержки p50/p99/p999/max/mean в микросекундах
+        void WriteReport(std::ostream& output, json::Writer::Format format = json::Writer::Format::PRETTY) const;
+
+    private:
+        static constexpr size_t TYPE_COUNT = 4;
+
+        struct TypeMetrics {
+            uint64_t errors = 0;
+            LatencyHistogram latency;
+        };
+
+        std::array<TypeMetrics, TYPE_COUNT> types_;
+    };
+
+    // Пишет отчёт в std::cerr, если target == "stderr", иначе в файл target
+    void WriteReport(const RequestMetrics& metrics, const std::string& target);
+
+}  // namespace metrics
@@ -1,12 +1,16 @@
 #pragma once
 
 #include "graph.h"
+#include "search_space.h"
+#include "trace.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <functional>
 #include <iterator>
 #include <optional>
+#include <queue>
 #include <stdexcept>
 #include <unordered_map>
 #include <utility>
@@ -14,13 +18,19 @@
 
 namespace graph {
 
+// Способ поиска кратчайшего пути, которым Router отвечает на BuildRoute
+enum class SearchMode {
+    DIJKSTRA,
+    BIDIRECTIONAL,
+};
+
 template <typename Weight>
 class Router {
 private:
     using Graph = DirectedWeightedGraph<Weight>;
 
 public:
-    explicit Router(const Graph& graph);
+    explicit Router(const Graph& graph, SearchMode mode = SearchMode::DIJKSTRA);
 
     struct RouteInfo {
         Weight weight;
@@ -29,89 +39,169 @@ public:
 
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
-private:
-    struct RouteInternalData {
-        Weight weight;
-        std::optional<EdgeId> prev_edge;
-    };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+    SearchMode GetSearchMode() const {
+        return mode_;
+    }
 
-    void InitializeRoutesInternalData(const Graph& graph) {
+private:
+    void InitializeReverseIncidence(const Graph& graph) {
         const size_t vertex_count = graph.GetVertexCount();
+        reverse_offsets_.assign(vertex_count + 1, 0);
         for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-            routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
-            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
-                const auto& edge = graph.GetEdge(edge_id);
-                if (edge.weight < ZERO_WEIGHT) {
-                    throw std::domain_error("Edges' weights should be non-negative");
-                }
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{edge.weight, edge_id};
-                }
-            }
+            graph.ForEachIncidentEdge(vertex, [this](EdgeId, VertexId edge_to, Weight) {
+                ++reverse_offsets_[edge_to + 1];
+            });
+        }
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            reverse_offsets_[vertex + 1] += reverse_offsets_[vertex];
+        }
+        reverse_edges_.resize(graph.GetEdgeCount());
+        reverse_sources_.resize(graph.GetEdgeCount());
+        reverse_weights_.resize(graph.GetEdgeCount());
+        std::vector<size_t> positions(reverse_offsets_.begin(), std::prev(reverse_offsets_.end()));
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            graph.ForEachIncidentEdge(vertex, [&](EdgeId edge_id, VertexId edge_to, Weight edge_weight) {
+                const size_t position = positions[edge_to]++;
+                reverse_edges_[position] = edge_id;
+                reverse_sources_[position] = vertex;
+                reverse_weights_[position] = edge_weight;
+            });
         }
     }
 
-    void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-                    const RouteInternalData& route_to) {
-        auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-        const Weight candidate_weight = route_from.weight + route_to.weight;
-        if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-            route_relaxing = {candidate_weight,
-                              route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+    std::optional<RouteInfo> BuildRouteDijkstra(VertexId from, VertexId to, SearchSpace<Weight>& space) const {
+        space.Reset();
+        space.Reach(from, ZERO_WEIGHT, NO_EDGE);
+        while (const auto vertex = space.Settle()) {
+            if (*vertex == to) {
+                break;
+            }
+            graph_.ForEachIncidentEdge(*vertex, [&space, vertex](EdgeId edge_id, VertexId edge_to, Weight edge_weight) {
+                space.Relax(edge_to, space.weight[*vertex] + edge_weight, edge_id);
+            });
         }
+        if (!space.IsSettled(to)) {
+            return std::nullopt;
+        }
+
+        std::vector<EdgeId> edges;
+        for (EdgeId edge_id = space.prev_edge[to]; edge_id != NO_EDGE;
+             edge_id = space.prev_edge[graph_.GetEdge(edge_id).from]) {
+            edges.push_back(edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+        return RouteInfo{space.weight[to], std::move(edges)};
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
-                    }
+    std::optional<RouteInfo> BuildRouteBidirectional(VertexId from, VertexId to,
+                                                     SearchSpace<Weight>& forward, SearchSpace<Weight>& backward) const {
+        forward.Reset();
+        backward.Reset();
+        forward.Reach(from, ZERO_WEIGHT, NO_EDGE);
+        backward.Reach(to, ZERO_WEIGHT, NO_EDGE);
+
+        std::optional<Weight> best_weight;
+        VertexId meeting_vertex = from;
+        auto try_meet = [&](VertexId vertex) {
+            if (forward.IsReached(vertex) && backward.IsReached(vertex)) {
+                const Weight candidate = forward.weight[vertex] + backward.weight[vertex];
+                if (!best_weight || candidate < *best_weight) {
+                    best_weight = candidate;
+                    meeting_vertex = vertex;
+                }
+            }
+        };
+        try_meet(from);
+
+        // Поиск прекращается, когда сумма минимумов обеих очередей не меньше
+        // уже найденного пути: более короткого пути через неосвоенные вершины нет
+        while (true) {
+            const auto forward_min = forward.MinQueued();
+            const auto backward_min = backward.MinQueued();
+            if (!forward_min || !backward_min) {
+                break;
+            }
+            if (best_weight && !(*forward_min + *backward_min < *best_weight)) {
+                break;
+            }
+            if (!(*backward_min < *forward_min)) {
+                const VertexId vertex = *forward.Settle();
+                graph_.ForEachIncidentEdge(vertex, [&](EdgeId edge_id, VertexId edge_to, Weight edge_weight) {
+                    forward.Relax(edge_to, forward.weight[vertex] + edge_weight, edge_id);
+                    try_meet(edge_to);
+                });
+            }
+            else {
+                const VertexId vertex = *backward.Settle();
+                for (size_t i = reverse_offsets_[vertex]; i < reverse_offsets_[vertex + 1]; ++i) {
+                    backward.Relax(reverse_sources_[i], backward.weight[vertex] + reverse_weights_[i], reverse_edges_[i]);
+                    try_meet(reverse_sources_[i]);
                 }
             }
         }
+        if (!best_weight) {
+            return std::nullopt;
+        }
+
+        std::vector<EdgeId> edges;
+        for (EdgeId edge_id = forward.prev_edge[meeting_vertex]; edge_id != NO_EDGE;
+             edge_id = forward.prev_edge[graph_.GetEdge(edge_id).from]) {
+            edges.push_back(edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+        for (EdgeId edge_id = backward.prev_edge[meeting_vertex]; edge_id != NO_EDGE;
+             edge_id = backward.prev_edge[graph_.GetEdge(edge_id).to]) {
+            edges.push_back(edge_id);
+        }
+        return RouteInfo{*best_weight, std::move(edges)};
     }
 
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
-    RoutesInternalData routes_internal_data_;
+    const SearchMode mode_;
+    // Обратные списки инцидентности в формате CSR, нужны только двунаправленному поиску.
+    // Начала и веса рёбер лежат рядом с id, как концы и веса в прямом CSR графа
+    std::vector<size_t> reverse_offsets_;
+    std::vector<EdgeId> reverse_edges_;
+    std::vector<VertexId> reverse_sources_;
+    std::vector<Weight> reverse_weights_;
+    // Состояния поиска выдаются каждому запросу отдельно, поэтому BuildRoute
+    // можно вызывать из нескольких потоков одновременно
+    mutable SearchSpacePool<Weight> spaces_;
 };
 
 template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+Router<Weight>::Router(const Graph& graph, SearchMode mode)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+    , mode_(mode)
+    , spaces_(graph.GetVertexCount(), mode == SearchMode::BIDIRECTIONAL ? graph.GetVertexCount() : 0)
 {
-    InitializeRoutesInternalData(graph);
-
-    const size_t vertex_count = graph.GetVertexCount();
-    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+    TRACE_SCOPE("graph::Router");
+    for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+        graph.ForEachIncidentEdge(vertex, [](EdgeId, VertexId, Weight edge_weight) {
+            if (edge_weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        });
+    }
+    if (mode_ == SearchMode::BIDIRECTIONAL) {
+        InitializeReverseIncidence(graph);
     }
 }
 
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-    if (!route_internal_data) {
-        return std::nullopt;
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
     }
-    const Weight weight = route_internal_data->weight;
-    std::vector<EdgeId> edges;
-    for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-         edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
-    {
-        edges.push_back(*edge_id);
+    const auto lease = spaces_.Acquire();
+    switch (mode_) {
+    case SearchMode::BIDIRECTIONAL:
+        return BuildRouteBidirectional(from, to, lease->forward, lease->backward);
+    default:
+        return BuildRouteDijkstra(from, to, lease->forward);
     }
-    std::reverse(edges.begin(), edges.end());
-
-    return RouteInfo{weight, std::move(edges)};
 }
 
-}  // namespace graph
\ No newline at end of file
+}  // namespace graph
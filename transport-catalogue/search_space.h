@@ -0,0 +1,157 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+inline constexpr EdgeId NO_EDGE = static_cast<EdgeId>(-1);
+
+// Состояние одного направления поиска Дейкстры. Вершины, которых поиск ещё не касался
+// в текущем запросе, отличаются по метке stamp, поэтому сброс между запросами
+// стоит O(1), а не O(V)
+template <typename Weight>
+struct SearchSpace {
+    using QueueItem = std::pair<Weight, VertexId>;
+
+    std::vector<Weight> weight;
+    std::vector<EdgeId> prev_edge;
+    std::vector<uint32_t> stamp;
+    std::vector<bool> settled;
+    uint32_t current = 0;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+    explicit SearchSpace(size_t vertex_count)
+        : weight(vertex_count)
+        , prev_edge(vertex_count, NO_EDGE)
+        , stamp(vertex_count, 0)
+        , settled(vertex_count, false) {
+    }
+
+    void Reset() {
+        if (++current == 0) {
+            std::fill(stamp.begin(), stamp.end(), 0);
+            current = 1;
+        }
+        queue = {};
+    }
+    bool IsReached(VertexId vertex) const {
+        return stamp[vertex] == current;
+    }
+    bool IsSettled(VertexId vertex) const {
+        return IsReached(vertex) && settled[vertex];
+    }
+    void Reach(VertexId vertex, Weight vertex_weight, EdgeId edge_id) {
+        if (!IsReached(vertex)) {
+            stamp[vertex] = current;
+            settled[vertex] = false;
+        }
+        weight[vertex] = vertex_weight;
+        prev_edge[vertex] = edge_id;
+        queue.push({vertex_weight, vertex});
+    }
+    // Обновляет вершину, если найден более короткий путь до неё
+    void Relax(VertexId vertex, Weight candidate_weight, EdgeId edge_id) {
+        if (!IsReached(vertex) || candidate_weight < weight[vertex]) {
+            Reach(vertex, candidate_weight, edge_id);
+        }
+    }
+    // Достаёт из очереди ближайшую неосвоенную вершину и помечает её освоенной
+    std::optional<VertexId> Settle() {
+        while (!queue.empty()) {
+            const auto [vertex_weight, vertex] = queue.top();
+            queue.pop();
+            if (settled[vertex] || vertex_weight > weight[vertex]) {
+                continue;
+            }
+            settled[vertex] = true;
+            return vertex;
+        }
+        return std::nullopt;
+    }
+    std::optional<Weight> MinQueued() {
+        while (!queue.empty() && (settled[queue.top().second]
+                                  || queue.top().first > weight[queue.top().second])) {
+            queue.pop();
+        }
+        if (queue.empty()) {
+            return std::nullopt;
+        }
+        return queue.top().first;
+    }
+};
+
+// Пара пространств для прямого и обратного направлений поиска
+template <typename Weight>
+struct SearchState {
+    SearchSpace<Weight> forward;
+    SearchSpace<Weight> backward;
+};
+
+// Потокобезопасный пул состояний поиска. Каждый запрос берёт себе отдельное состояние
+// и по завершении возвращает его, поэтому одновременные запросы не делят память,
+// а число выделенных состояний не превышает числа параллельно работающих потоков
+template <typename Weight>
+class SearchSpacePool {
+public:
+    class Lease {
+    public:
+        Lease(SearchSpacePool& pool, std::unique_ptr<SearchState<Weight>> state)
+            : pool_(pool)
+            , state_(std::move(state)) {
+        }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() {
+            pool_.Release(std::move(state_));
+        }
+
+        SearchState<Weight>* operator->() const {
+            return state_.get();
+        }
+
+    private:
+        SearchSpacePool& pool_;
+        std::unique_ptr<SearchState<Weight>> state_;
+    };
+
+    SearchSpacePool(size_t forward_size, size_t backward_size)
+        : forward_size_(forward_size)
+        , backward_size_(backward_size) {
+    }
+
+    Lease Acquire() {
+        {
+            std::lock_guard guard(mutex_);
+            if (!free_.empty()) {
+                std::unique_ptr<SearchState<Weight>> state = std::move(free_.back());
+                free_.pop_back();
+                return Lease(*this, std::move(state));
+            }
+        }
+        return Lease(*this, std::make_unique<SearchState<Weight>>(
+            SearchState<Weight>{SearchSpace<Weight>(forward_size_), SearchSpace<Weight>(backward_size_)}));
+    }
+
+private:
+    void Release(std::unique_ptr<SearchState<Weight>> state) {
+        std::lock_guard guard(mutex_);
+        free_.push_back(std::move(state));
+    }
+
+    size_t forward_size_;
+    size_t backward_size_;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<SearchState<Weight>>> free_;
+};
+
+}  // namespace graph
@@ -0,0 +1,688 @@
+#include "serialization.h"
+#include "ranges.h"
+#include "trace.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace serialization {
+
+    namespace {
+        constexpr char MAGIC[8] = { 'T', 'C', 'S', 'N', 'A', 'P', '\0', '\0' };
+        constexpr char ROUTER_MAGIC[8] = { 'T', 'C', 'R', 'O', 'U', 'T', 'E', '\0' };
+        // Увеличиваются при любом изменении раскладки данных
+        constexpr uint32_t FORMAT_VERSION = 3;
+        constexpr uint32_t ROUTER_FORMAT_VERSION = 3;
+        // Записывается в порядке байтов машины: на машине с другим порядком не совпадёт
+        constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+        struct Header {
+            char magic[8];
+            uint32_t version;
+            uint32_t byte_order;
+            uint64_t payload_size;
+            uint64_t checksum;
+        };
+
+        // FNV-1a по 64-битным словам: от контрольной суммы нужно только
+        // обнаружение повреждений, а побайтовый вариант заметно медленнее
+        uint64_t Checksum(const char* data, size_t size) {
+            const uint64_t prime = 0x100000001b3ULL;
+            uint64_t hash = 0xcbf29ce484222325ULL;
+            size_t i = 0;
+            for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+                uint64_t word;
+                memcpy(&word, data + i, sizeof(word));
+                hash = (hash ^ word) * prime;
+            }
+            for (; i < size; ++i) {
+                hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+            }
+            return hash;
+        }
+
+        // Дописывает значения в буфер, выравнивая каждое по его естественной границе,
+        // чтобы при чтении массивы можно было использовать прямо из отображённого файла
+        class BinaryWriter {
+        public:
+            template <typename T>
+            void Write(T value) {
+                static_assert(is_trivially_copyable_v<T>);
+                Align(alignof(T));
+                data_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+
+            template <typename T>
+            void WriteArray(const vector<T>& values) {
+                static_assert(is_trivially_copyable_v<T>);
+                Write<uint64_t>(values.size());
+                Align(alignof(T));
+                data_.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+            }
+
+            void WriteString(string_view str) {
+                Write<uint64_t>(str.size());
+                data_.append(str);
+            }
+
+            const string& GetData() const {
+                return data_;
+            }
+
+        private:
+            void Align(size_t alignment) {
+                data_.resize((data_.size() + alignment - 1) / alignment * alignment, '\0');
+            }
+
+            string data_;
+        };
+
+        // Читает то, что записал BinaryWriter. Массивы не копируются,
+        // а возвращаются как диапазоны внутри буфера
+        class BinaryReader {
+        public:
+            BinaryReader(const char* begin, const char* end)
+                : begin_(begin)
+                , pos_(begin)
+                , end_(end) {
+            }
+
+            template <typename T>
+            T Read() {
+                Align(alignof(T));
+                Require(sizeof(T));
+                T value;
+                memcpy(&value, pos_, sizeof(T));
+                pos_ += sizeof(T);
+                return value;
+            }
+
+            template <typename T>
+            ranges::Range<const T*> ReadArray() {
+                const uint64_t count = Read<uint64_t>();
+                Align(alignof(T));
+                if (count > static_cast<uint64_t>(end_ - pos_) / sizeof(T)) {
+                    throw SnapshotError("Snapshot is truncated");
+                }
+                const T* data = reinterpret_cast<const T*>(pos_);
+                pos_ += count * sizeof(T);
+                return { data, data + count };
+            }
+
+            string_view ReadString() {
+                const uint64_t size = Read<uint64_t>();
+                Require(size);
+                const string_view str(pos_, size);
+                pos_ += size;
+                return str;
+            }
+
+            bool AtEnd() const {
+                return pos_ == end_;
+            }
+
+            const char* GetPosition() const {
+                return pos_;
+            }
+
+        private:
+            void Align(size_t alignment) {
+                const size_t offset = static_cast<size_t>(pos_ - begin_);
+                Require((alignment - offset % alignment) % alignment);
+                pos_ += (alignment - offset % alignment) % alignment;
+            }
+
+            void Require(uint64_t size) const {
+                if (size > static_cast<uint64_t>(end_ - pos_)) {
+                    throw SnapshotError("Snapshot is truncated");
+                }
+            }
+
+            const char* begin_;
+            const char* pos_;
+            const char* end_;
+        };
+
+        // Файл, отображённый в память только для чтения
+        class MappedFile {
+        public:
+            explicit MappedFile(const string& path) {
+                const int fd = open(path.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    throw runtime_error("Can't open "s + path + ": "s + strerror(errno));
+                }
+                struct stat info;
+                if (fstat(fd, &info) != 0) {
+                    close(fd);
+                    throw runtime_error("Can't stat "s + path + ": "s + strerror(errno));
+                }
+                size_ = static_cast<size_t>(info.st_size);
+                if (size_ > 0) {
+                    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (data == MAP_FAILED) {
+                        close(fd);
+                        throw runtime_error("Can't map "s + path + ": "s + strerror(errno));
+                    }
+                    data_ = static_cast<const char*>(data);
+                }
+                close(fd);
+            }
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+            ~MappedFile() {
+                if (data_) {
+                    munmap(const_cast<char*>(data_), size_);
+                }
+            }
+
+            const char* GetData() const {
+                return data_;
+            }
+            size_t GetSize() const {
+                return size_;
+            }
+
+        private:
+            const char* data_ = nullptr;
+            size_t size_ = 0;
+        };
+
+        template <typename Names>
+        void WriteNames(BinaryWriter& writer, const Names& items) {
+            vector<uint64_t> offsets{ 0 };
+            vector<char> chars;
+            for (const auto& item : items) {
+                chars.insert(chars.end(), item.name.begin(), item.name.end());
+                offsets.push_back(chars.size());
+            }
+            writer.WriteArray(offsets);
+            writer.WriteArray(chars);
+        }
+
+        // Имена хранятся одним блоком символов и массивом смещений (на одно больше, чем имён)
+        struct NamesView {
+            ranges::Range<const uint64_t*> offsets;
+            ranges::Range<const char*> chars;
+
+            size_t GetCount() const {
+                return offsets.end() - offsets.begin() - 1;
+            }
+            string_view operator[](size_t i) const {
+                const uint64_t begin = offsets.begin()[i];
+                const uint64_t end = offsets.begin()[i + 1];
+                return { chars.begin() + begin, static_cast<size_t>(end - begin) };
+            }
+        };
+
+        NamesView ReadNames(BinaryReader& reader) {
+            NamesView names{ reader.ReadArray<uint64_t>(), reader.ReadArray<char>() };
+            const size_t offset_count = names.offsets.end() - names.offsets.begin();
+            const size_t char_count = names.chars.end() - names.chars.begin();
+            if (offset_count == 0 || names.offsets.begin()[0] != 0) {
+                throw SnapshotError("Malformed name table");
+            }
+            for (size_t i = 1; i < offset_count; ++i) {
+                if (names.offsets.begin()[i] < names.offsets.begin()[i - 1] || names.offsets.begin()[i] > char_count) {
+                    throw SnapshotError("Malformed name table");
+                }
+            }
+            return names;
+        }
+
+        template <typename T>
+        size_t Size(ranges::Range<const T*> range) {
+            return static_cast<size_t>(range.end() - range.begin());
+        }
+
+        uint32_t CheckIndex(uint64_t index, size_t count) {
+            if (index >= count) {
+                throw SnapshotError("Index is out of range");
+            }
+            return static_cast<uint32_t>(index);
+        }
+
+        void WriteColor(BinaryWriter& writer, const svg::Color& color) {
+            writer.Write<uint8_t>(static_cast<uint8_t>(color.index()));
+            if (const auto* str = get_if<string>(&color)) {
+                writer.WriteString(*str);
+            }
+            else if (const auto* rgb = get_if<svg::Rgb>(&color)) {
+                writer.Write(rgb->red);
+                writer.Write(rgb->green);
+                writer.Write(rgb->blue);
+            }
+            else if (const auto* rgba = get_if<svg::Rgba>(&color)) {
+                writer.Write(rgba->red);
+                writer.Write(rgba->green);
+                writer.Write(rgba->blue);
+                writer.Write(rgba->opacity);
+            }
+        }
+
+        svg::Color ReadColor(BinaryReader& reader) {
+            switch (reader.Read<uint8_t>()) {
+            case 0:
+                return monostate{};
+            case 1:
+                return string(reader.ReadString());
+            case 2: {
+                const uint8_t red = reader.Read<uint8_t>();
+                const uint8_t green = reader.Read<uint8_t>();
+                const uint8_t blue = reader.Read<uint8_t>();
+                return svg::Rgb(red, green, blue);
+            }
+            case 3: {
+                const uint8_t red = reader.Read<uint8_t>();
+                const uint8_t green = reader.Read<uint8_t>();
+                const uint8_t blue = reader.Read<uint8_t>();
+                return svg::Rgba(red, green, blue, reader.Read<double>());
+            }
+            default:
+                throw SnapshotError("Unknown color type");
+            }
+        }
+
+        void WriteOffset(BinaryWriter& writer, const Offset& offset) {
+            writer.Write(offset.dx);
+            writer.Write(offset.dy);
+        }
+
+        Offset ReadOffset(BinaryReader& reader) {
+            Offset offset;
+            offset.dx = reader.Read<double>();
+            offset.dy = reader.Read<double>();
+            return offset;
+        }
+
+        void WriteCatalogue(BinaryWriter& writer, const transport::core::TransportCatalogue& catalogue) {
+            const auto& stops = catalogue.GetAllStops();
+            WriteNames(writer, stops);
+            vector<double> latitudes;
+            vector<double> longitudes;
+            for (const Stop& stop : stops) {
+                latitudes.push_back(stop.coordinates.lat);
+                longitudes.push_back(stop.coordinates.lng);
+            }
+            writer.WriteArray(latitudes);
+            writer.WriteArray(longitudes);
+
+            // Таблица расстояний в формате CSR по остановке отправления
+            vector<uint64_t> distance_offsets{ 0 };
+            vector<uint32_t> distance_to;
+            vector<int32_t> distances;
+            for (size_t from = 0; from < stops.size(); ++from) {
+                catalogue.ForEachDistance(from, [&](size_t to, int distance) {
+                    distance_to.push_back(static_cast<uint32_t>(to));
+                    distances.push_back(distance);
+                });
+                distance_offsets.push_back(distance_to.size());
+            }
+            writer.WriteArray(distance_offsets);
+            writer.WriteArray(distance_to);
+            writer.WriteArray(distances);
+
+            const auto& routes = catalogue.GetAllBuses();
+            WriteNames(writer, routes);
+            vector<uint64_t> route_offsets{ 0 };
+            vector<uint32_t> route_stops;
+            vector<uint32_t> last_stops;
+            for (const Route& route : routes) {
+                route_stops.insert(route_stops.end(), route.stops.begin(), route.stops.end());
+                route_offsets.push_back(route_stops.size());
+                last_stops.push_back(route.last_stop);
+            }
+            writer.WriteArray(route_offsets);
+            writer.WriteArray(route_stops);
+            writer.WriteArray(last_stops);
+
+            // Статистика маршрутов, чтобы при загрузке не считать длины заново
+            vector<uint64_t> stop_counts;
+            vector<uint64_t> unique_stop_counts;
+            vector<int32_t> route_lengths;
+            vector<double> curvatures;
+            for (const auto& stat : catalogue.GetRouteStats()) {
+                stop_counts.push_back(stat.count_of_stops);
+                unique_stop_counts.push_back(stat.count_of_unique_stops);
+                route_lengths.push_back(stat.route_length);
+                curvatures.push_back(stat.curvature);
+            }
+            writer.WriteArray(stop_counts);
+            writer.WriteArray(unique_stop_counts);
+            writer.WriteArray(route_lengths);
+            writer.WriteArray(curvatures);
+        }
+
+        void ReadCatalogue(BinaryReader& reader, transport::core::TransportCatalogue& catalogue) {
+            const NamesView stop_names = ReadNames(reader);
+            const auto latitudes = reader.ReadArray<double>();
+            const auto longitudes = reader.ReadArray<double>();
+            const size_t stop_count = stop_names.GetCount();
+            if (Size(latitudes) != stop_count || Size(longitudes) != stop_count) {
+                throw SnapshotError("Malformed stops");
+            }
+            for (size_t i = 0; i < stop_count; ++i) {
+                catalogue.AddStop(string(stop_names[i]), { latitudes.begin()[i], longitudes.begin()[i] });
+            }
+
+            const auto distance_offsets = reader.ReadArray<uint64_t>();
+            const auto distance_to = reader.ReadArray<uint32_t>();
+            const auto distances = reader.ReadArray<int32_t>();
+            if (Size(distance_offsets) != stop_count + 1 || Size(distance_to) != Size(distances)) {
+                throw SnapshotError("Malformed distance table");
+            }
+            for (size_t from = 0; from < stop_count; ++from) {
+                const uint64_t begin = distance_offsets.begin()[from];
+                const uint64_t end = distance_offsets.begin()[from + 1];
+                if (begin > end || end > Size(distances)) {
+                    throw SnapshotError("Malformed distance table");
+                }
+                for (uint64_t i = begin; i < end; ++i) {
+                    const uint32_t to = CheckIndex(distance_to.begin()[i], stop_count);
+                    catalogue.AddDistance(&catalogue.GetStop(from), &catalogue.GetStop(to), distances.begin()[i]);
+                }
+            }
+
+            const NamesView route_names = ReadNames(reader);
+            const auto route_offsets = reader.ReadArray<uint64_t>();
+            const auto route_stops = reader.ReadArray<uint32_t>();
+            const auto last_stops = reader.ReadArray<uint32_t>();
+            const size_t route_count = route_names.GetCount();
+            if (Size(route_offsets) != route_count + 1 || Size(last_stops) != route_count) {
+                throw SnapshotError("Malformed routes");
+            }
+            for (size_t i = 0; i < route_count; ++i) {
+                const uint64_t begin = route_offsets.begin()[i];
+                const uint64_t end = route_offsets.begin()[i + 1];
+                if (begin >= end || end > Size(route_stops)) {
+                    throw SnapshotError("Malformed routes");
+                }
+                vector<uint32_t> stops;
+                stops.reserve(end - begin);
+                for (uint64_t j = begin; j < end; ++j) {
+                    stops.push_back(CheckIndex(route_stops.begin()[j], stop_count));
+                }
+                catalogue.AddRoute(string(route_names[i]), move(stops), CheckIndex(last_stops.begin()[i], stop_count));
+            }
+
+            const auto stop_counts = reader.ReadArray<uint64_t>();
+            const auto unique_stop_counts = reader.ReadArray<uint64_t>();
+            const auto route_lengths = reader.ReadArray<int32_t>();
+            const auto curvatures = reader.ReadArray<double>();
+            if (Size(stop_counts) != route_count || Size(unique_stop_counts) != route_count
+                || Size(route_lengths) != route_count || Size(curvatures) != route_count) {
+                throw SnapshotError("Malformed route stats");
+            }
+            vector<transport::core::TransportCatalogue::RouteStat> route_stats;
+            route_stats.reserve(route_count);
+            for (size_t i = 0; i < route_count; ++i) {
+                route_stats.push_back({ stop_counts.begin()[i], unique_stop_counts.begin()[i],
+                                        route_lengths.begin()[i], curvatures.begin()[i] });
+            }
+            catalogue.Finalize(move(route_stats));
+        }
+
+        void WriteRenderSettings(BinaryWriter& writer, const RenderSettings& settings) {
+            writer.Write(settings.width);
+            writer.Write(settings.height);
+            writer.Write(settings.padding);
+            writer.Write(settings.line_width);
+            writer.Write(settings.stop_radius);
+            writer.Write<int32_t>(settings.bus_label_font_size);
+            WriteOffset(writer, settings.bus_label_offset);
+            writer.Write<int32_t>(settings.stop_label_font_size);
+            WriteOffset(writer, settings.stop_label_offset);
+            WriteColor(writer, settings.underlayer_color);
+            writer.Write(settings.underlayer_width);
+            writer.Write<uint64_t>(settings.color_palette.size());
+            for (const svg::Color& color : settings.color_palette) {
+                WriteColor(writer, color);
+            }
+        }
+
+        RenderSettings ReadRenderSettings(BinaryReader& reader) {
+            RenderSettings settings;
+            settings.width = reader.Read<double>();
+            settings.height = reader.Read<double>();
+            settings.padding = reader.Read<double>();
+            settings.line_width = reader.Read<double>();
+            settings.stop_radius = reader.Read<double>();
+            settings.bus_label_font_size = reader.Read<int32_t>();
+            settings.bus_label_offset = ReadOffset(reader);
+            settings.stop_label_font_size = reader.Read<int32_t>();
+            settings.stop_label_offset = ReadOffset(reader);
+            settings.underlayer_color = ReadColor(reader);
+            settings.underlayer_width = reader.Read<double>();
+            const uint64_t palette_size = reader.Read<uint64_t>();
+            for (uint64_t i = 0; i < palette_size; ++i) {
+                settings.color_palette.push_back(ReadColor(reader));
+            }
+            return settings;
+        }
+
+        void WriteRoutingSettings(BinaryWriter& writer, const RoutingSettings& settings) {
+            writer.Write<int32_t>(settings.bus_wait_time);
+            writer.Write(settings.bus_velocity);
+            writer.Write<uint8_t>(static_cast<uint8_t>(settings.search_mode));
+        }
+
+        RoutingSettings ReadRoutingSettings(BinaryReader& reader) {
+            RoutingSettings settings;
+            settings.bus_wait_time = reader.Read<int32_t>();
+            settings.bus_velocity = reader.Read<double>();
+            const uint8_t mode = reader.Read<uint8_t>();
+            if (mode > static_cast<uint8_t>(graph::SearchMode::BIDIRECTIONAL)) {
+                throw SnapshotError("Unknown search mode");
+            }
+            settings.search_mode = static_cast<graph::SearchMode>(mode);
+            return settings;
+        }
+
+        // Рёбра графа и описания участков маршрутов, по одному на ребро
+        void WriteRouter(BinaryWriter& writer, const Transport_router& router) {
+            const Transport_router::Graph& graph = router.GetGraph();
+            writer.Write<uint64_t>(graph.GetVertexCount());
+            vector<uint32_t> from;
+            vector<uint32_t> to;
+            vector<uint64_t> ticks;
+            vector<uint64_t> ties;
+            for (graph::EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+                const auto& edge = graph.GetEdge(edge_id);
+                from.push_back(static_cast<uint32_t>(edge.from));
+                to.push_back(static_cast<uint32_t>(edge.to));
+                ticks.push_back(edge.weight.ticks);
+                ties.push_back(edge.weight.tie);
+            }
+            writer.WriteArray(from);
+            writer.WriteArray(to);
+            writer.WriteArray(ticks);
+            writer.WriteArray(ties);
+
+            vector<uint32_t> item_stops;
+            vector<uint32_t> item_buses;
+            vector<double> item_times;
+            vector<int32_t> item_spans;
+            for (const RouteItem& item : router.GetItems()) {
+                item_stops.push_back(static_cast<uint32_t>(item.stop->idx));
+                item_buses.push_back(static_cast<uint32_t>(item.bus->idx));
+                item_times.push_back(item.time);
+                item_spans.push_back(item.span_count);
+            }
+            writer.WriteArray(item_stops);
+            writer.WriteArray(item_buses);
+            writer.WriteArray(item_times);
+            writer.WriteArray(item_spans);
+        }
+
+        void ReadRouter(BinaryReader& reader, TransportBase& base) {
+            const auto& catalogue = base.catalogue;
+            const uint64_t vertex_count = reader.Read<uint64_t>();
+            if (vertex_count != catalogue.GetStopsCount()) {
+                throw SnapshotError("Router graph doesn't match the catalogue");
+            }
+            const auto from = reader.ReadArray<uint32_t>();
+            const auto to = reader.ReadArray<uint32_t>();
+            const auto ticks = reader.ReadArray<uint64_t>();
+            const auto ties = reader.ReadArray<uint64_t>();
+            const auto item_stops = reader.ReadArray<uint32_t>();
+            const auto item_buses = reader.ReadArray<uint32_t>();
+            const auto item_times = reader.ReadArray<double>();
+            const auto item_spans = reader.ReadArray<int32_t>();
+            const size_t edge_count = Size(from);
+            if (Size(to) != edge_count || Size(ticks) != edge_count || Size(ties) != edge_count
+                || Size(item_stops) != edge_count || Size(item_buses) != edge_count
+                || Size(item_times) != edge_count || Size(item_spans) != edge_count) {
+                throw SnapshotError("Malformed router graph");
+            }
+
+            vector<graph::Edge<RouteWeight>> edges;
+            edges.reserve(edge_count);
+            vector<RouteItem> items;
+            items.reserve(edge_count);
+            const auto& buses = catalogue.GetAllBuses();
+            for (size_t i = 0; i < edge_count; ++i) {
+                edges.push_back({ CheckIndex(from.begin()[i], vertex_count), CheckIndex(to.begin()[i], vertex_count),
+                                  RouteWeight{ ticks.begin()[i], ties.begin()[i] } });
+                items.push_back({ &catalogue.GetStop(CheckIndex(item_stops.begin()[i], catalogue.GetStopsCount())),
+                                  &buses[CheckIndex(item_buses.begin()[i], buses.size())],
+                                  item_times.begin()[i], item_spans.begin()[i] });
+            }
+            // Граф строится сразу замороженным, без списков инцидентности AddEdge
+            Transport_router::Graph graph(vertex_count, move(edges));
+            base.router.emplace(base.catalogue, base.routing_settings, move(graph), move(items));
+        }
+
+        // Хэш байтов каталога и настроек маршрутизации в том виде, в каком они лежат в снимке.
+        // Индекс маршрутизатора хранит его и годится только для снимка с тем же хэшем
+        uint64_t BaseHash(string_view catalogue, string_view routing_settings) {
+            const uint64_t hashes[2] = { Checksum(catalogue.data(), catalogue.size()),
+                                         Checksum(routing_settings.data(), routing_settings.size()) };
+            return Checksum(reinterpret_cast<const char*>(hashes), sizeof(hashes));
+        }
+
+        void WriteFile(const string& path, const char (&magic)[8], uint32_t version, const string& payload) {
+            Header header;
+            memcpy(header.magic, magic, sizeof(header.magic));
+            header.version = version;
+            header.byte_order = BYTE_ORDER_MARK;
+            header.payload_size = payload.size();
+            header.checksum = Checksum(payload.data(), payload.size());
+
+            const string temp_path = path + ".tmp"s;
+            {
+                ofstream output(temp_path, ios::binary | ios::trunc);
+                output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                output.write(payload.data(), static_cast<streamsize>(payload.size()));
+                if (!output) {
+                    throw runtime_error("Can't write "s + temp_path);
+                }
+            }
+            if (rename(temp_path.c_str(), path.c_str()) != 0) {
+                throw runtime_error("Can't rename "s + temp_path + " to "s + path + ": "s + strerror(errno));
+            }
+        }
+
+        // Проверяет заголовок и контрольную сумму и возвращает читателя полезной нагрузки
+        BinaryReader OpenPayload(const MappedFile& file, const char (&magic)[8], uint32_t version) {
+            if (file.GetSize() < sizeof(Header)) {
+                throw SnapshotError("Snapshot is truncated");
+            }
+            Header header;
+            memcpy(&header, file.GetData(), sizeof(header));
+            if (memcmp(header.magic, magic, sizeof(header.magic)) != 0) {
+                throw SnapshotError("Not a transport catalogue snapshot");
+            }
+            if (header.byte_order != BYTE_ORDER_MARK) {
+                throw SnapshotError("Snapshot was written with a different byte order");
+            }
+            if (header.version != version) {
+                throw SnapshotError("Unsupported snapshot version "s + to_string(header.version));
+            }
+            if (header.payload_size != file.GetSize() - sizeof(Header)) {
+                throw SnapshotError("Snapshot is truncated");
+            }
+            const char* payload = file.GetData() + sizeof(Header);
+            if (Checksum(payload, header.payload_size) != header.checksum) {
+                throw SnapshotError("Snapshot checksum mismatch");
+            }
+            return BinaryReader(payload, payload + header.payload_size);
+        }
+
+        void LoadRouterIndex(const string& path, uint64_t base_hash, TransportBase& base) {
+            TRACE_SCOPE("serialization::LoadRouterIndex");
+            const MappedFile file(path);
+            BinaryReader reader = OpenPayload(file, ROUTER_MAGIC, ROUTER_FORMAT_VERSION);
+            if (reader.Read<uint64_t>() != base_hash) {
+                throw SnapshotError("Router index was built from a different base");
+            }
+            ReadRouter(reader, base);
+            if (!reader.AtEnd()) {
+                throw SnapshotError("Unexpected data at the end of router index");
+            }
+        }
+    }
+
+    std::string GetRouterIndexPath(const std::string& path) {
+        return path + ".router"s;
+    }
+
+    void SaveBase(const std::string& path, const TransportBase& base) {
+        TRACE_SCOPE("serialization::SaveBase");
+        BinaryWriter writer;
+        WriteCatalogue(writer, base.catalogue);
+        const size_t catalogue_end = writer.GetData().size();
+        WriteRenderSettings(writer, base.render_settings);
+        const size_t routing_begin = writer.GetData().size();
+        WriteRoutingSettings(writer, base.routing_settings);
+        const string_view payload = writer.GetData();
+        const uint64_t base_hash = BaseHash(payload.substr(0, catalogue_end), payload.substr(routing_begin));
+
+        // Сначала индекс: если снимок не успеет записаться, старый снимок
+        // не примет новый индекс из-за несовпадения хэша
+        BinaryWriter router_writer;
+        router_writer.Write<uint64_t>(base_hash);
+        WriteRouter(router_writer, *base.router);
+        WriteFile(GetRouterIndexPath(path), ROUTER_MAGIC, ROUTER_FORMAT_VERSION, router_writer.GetData());
+        WriteFile(path, MAGIC, FORMAT_VERSION, writer.GetData());
+    }
+
+    void LoadBase(const std::string& path, TransportBase& base) {
+        TRACE_SCOPE("serialization::LoadBase");
+        const MappedFile file(path);
+        BinaryReader reader = OpenPayload(file, MAGIC, FORMAT_VERSION);
+        const char* catalogue_begin = reader.GetPosition();
+        ReadCatalogue(reader, base.catalogue);
+        const char* catalogue_end = reader.GetPosition();
+        base.render_settings = ReadRenderSettings(reader);
+        const char* routing_begin = reader.GetPosition();
+        base.routing_settings = ReadRoutingSettings(reader);
+        const char* routing_end = reader.GetPosition();
+        if (!reader.AtEnd()) {
+            throw SnapshotError("Unexpected data at the end of snapshot");
+        }
+
+        const uint64_t base_hash = BaseHash({ catalogue_begin, static_cast<size_t>(catalogue_end - catalogue_begin) },
+                                            { routing_begin, static_cast<size_t>(routing_end - routing_begin) });
+        try {
+            LoadRouterIndex(GetRouterIndexPath(path), base_hash, base);
+            return;
+        }
+        catch (const exception& e) {
+            cerr << "Router index is ignored, rebuilding: "sv << e.what() << endl;
+        }
+        base.router.emplace(base.catalogue, base.routing_settings);
+    }
+
+}  // namespace serialization
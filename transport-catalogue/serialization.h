@@ -0,0 +1,46 @@
+#pragma once
+
+#include "map_renderer.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+namespace serialization {
+
+    // Снимок повреждён, обрезан или записан несовместимой версией
+    class SnapshotError : public std::runtime_error {
+    public:
+        using runtime_error::runtime_error;
+    };
+
+    // Всё, что нужно для ответов на stat_requests без исходного JSON
+    struct TransportBase {
+        transport::core::TransportCatalogue catalogue;
+        RenderSettings render_settings;
+        RoutingSettings routing_settings;
+        std::optional<Transport_router> router;
+    };
+
+    /*
+     * Пишет снимок базы: заголовок с версией формата и контрольной суммой,
+     * затем остановки, маршруты как массивы индексов, таблицу расстояний,
+     * статистику маршрутов, настройки отрисовки и маршрутизации.
+     * Граф маршрутизатора и описания его рёбер пишутся отдельным файлом
+     * GetRouterIndexPath(path) вместе с хэшем каталога и настроек маршрутизации.
+     * Файлы сначала пишутся во временные и затем переименовываются,
+     * так что читатели никогда не видят их наполовину записанными
+     */
+    void SaveBase(const std::string& path, const TransportBase& base);
+
+    // Отображает снимок в память, проверяет заголовок и контрольную сумму
+    // и заполняет base. Маршрутизатор берётся из индекса, если его хэш совпадает
+    // с загруженными каталогом и настройками; иначе индекс отвергается
+    // с сообщением в std::cerr и маршрутизатор строится заново
+    void LoadBase(const std::string& path, TransportBase& base);
+
+    std::string GetRouterIndexPath(const std::string& path);
+
+}  // namespace serialization
@@ -3,45 +3,42 @@
 namespace svg {
     using namespace std::literals;
 
-    std::ostream& operator<<(std::ostream& os, svg::StrokeLineCap slc) {
+    std::string_view ToString(StrokeLineCap slc) {
         switch (slc) {
             case svg::StrokeLineCap::BUTT:
-                os << "butt"sv;
-                break;
+                return "butt"sv;
             case svg::StrokeLineCap::ROUND:
-                os << "round"sv;
-                break;
+                return "round"sv;
             case svg::StrokeLineCap::SQUARE:
-                os << "square"sv;
-                break;
+                return "square"sv;
             default:
-                break;
+                return {};
         }
-        return os;
     }
 
-    std::ostream& operator<<(std::ostream& os, StrokeLineJoin slj) {
+    std::ostream& operator<<(std::ostream& os, svg::StrokeLineCap slc) {
+        return os << ToString(slc);
+    }
+
+    std::string_view ToString(StrokeLineJoin slj) {
         switch (slj) {
             case StrokeLineJoin::ARCS:
-                os << "arcs"sv;
-                break;
+                return "arcs"sv;
             case StrokeLineJoin::BEVEL:
-                os << "bevel"sv;
-                break;
+                return "bevel"sv;
             case StrokeLineJoin::MITER:
-                os << "miter"sv;
-                break;
+                return "miter"sv;
             case StrokeLineJoin::MITER_CLIP:
-                os << "miter-clip"sv;
-                break;
+                return "miter-clip"sv;
             case StrokeLineJoin::ROUND:
-                os << "round"sv;
-                break;
+                return "round"sv;
             default:
-                break;
+                return {};
         }
+    }
 
-        return os;
+    std::ostream& operator<<(std::ostream& os, StrokeLineJoin slj) {
+        return os << ToString(slj);
     }
 
     void Object::Render(const RenderContext& context) const {
@@ -65,13 +62,23 @@ namespace svg {
         return *this;
     }
 
-    void Circle::RenderObject(const RenderContext& context) const {
-        auto& out = context.out;
-        out << "<circle cx=\""sv << center_.x << "\" cy=\""sv << center_.y << "\" "sv;
-        out << "r=\""sv << radius_ << "\""sv;
+    void Circle::RenderTo(std::string& out) const {
+        out += "<circle cx=\""sv;
+        detail::AppendNumber(out, center_.x);
+        out += "\" cy=\""sv;
+        detail::AppendNumber(out, center_.y);
+        out += "\" r=\""sv;
+        detail::AppendNumber(out, radius_);
+        out += '"';
         // Выводим атрибуты, унаследованные от PathProps
-        RenderAttrs(context.out);
-        out << "/>"sv;
+        RenderAttrs(out);
+        out += "/>"sv;
+    }
+
+    void Circle::RenderObject(const RenderContext& context) const {
+        std::string out;
+        RenderTo(out);
+        context.out << out;
     }
 
     Polyline& Polyline::AddPoint(Point point) {
@@ -79,18 +86,25 @@ namespace svg {
         return *this;
     }
 
-    void Polyline::RenderObject(const RenderContext& context) const {
-        auto& out = context.out;
-        out << "<polyline points=\""sv;
+    void Polyline::RenderTo(std::string& out) const {
+        out += "<polyline points=\""sv;
         for (auto it = points_.begin(); it != points_.end(); it++) {
             if (it != points_.begin()) {
-                out << " ";
+                out += ' ';
             }
-            out << (*it).x << ","sv << (*it).y;
+            detail::AppendNumber(out, (*it).x);
+            out += ',';
+            detail::AppendNumber(out, (*it).y);
         }
-        out << "\""sv;
-        RenderAttrs(context.out);
-        out << "/>"sv;
+        out += '"';
+        RenderAttrs(out);
+        out += "/>"sv;
+    }
+
+    void Polyline::RenderObject(const RenderContext& context) const {
+        std::string out;
+        RenderTo(out);
+        context.out << out;
     }
 
     Text& Text::SetPosition(Point pos) {
@@ -109,49 +123,77 @@ namespace svg {
     }
 
     Text& Text::SetFontFamily(std::string font_family) {
-        font_family_ = font_family;
+        font_family_ = std::move(font_family);
         return *this;
     }
 
     Text& Text::SetFontWeight(std::string font_weight) {
-        font_weight_ = font_weight;
+        font_weight_ = std::move(font_weight);
         return *this;
     }
 
     Text& Text::SetData(std::string data) {
-        data_ = data;
+        data_ = std::move(data);
         return *this;
     }
 
-    void Text::RenderObject(const RenderContext& context) const {
-        auto& out = context.out;
-
-        out << "<text";
-        RenderAttrs(context.out);
-        out <<" x=\""sv << pos_.x << "\" y=\""sv << pos_.y << "\" "sv
-            << "dx=\""sv << offset_.x << "\" dy=\""sv << offset_.y << "\" "sv
-            << "font-size=\""sv << size_ << "\""sv;
+    void Text::RenderTo(std::string& out) const {
+        out += "<text"sv;
+        RenderAttrs(out);
+        out += " x=\""sv;
+        detail::AppendNumber(out, pos_.x);
+        out += "\" y=\""sv;
+        detail::AppendNumber(out, pos_.y);
+        out += "\" dx=\""sv;
+        detail::AppendNumber(out, offset_.x);
+        out += "\" dy=\""sv;
+        detail::AppendNumber(out, offset_.y);
+        out += "\" font-size=\""sv;
+        detail::AppendNumber(out, size_);
+        out += '"';
         if (!font_family_.empty()) {
-            out << " font-family=\""sv << font_family_ << "\""sv;
+            out += " font-family=\""sv;
+            out += font_family_;
+            out += '"';
         }
         if (!font_weight_.empty()) {
-            out << " font-weight=\""sv << font_weight_ << "\""sv;
+            out += " font-weight=\""sv;
+            out += font_weight_;
+            out += '"';
         }
-        out << ">"sv << data_ << "</text>"sv;
+        out += '>';
+        out += data_;
+        out += "</text>"sv;
+    }
+
+    void Text::RenderObject(const RenderContext& context) const {
+        std::string out;
+        RenderTo(out);
+        context.out << out;
     }
 
 
     void Document::AddPtr(std::unique_ptr<Object>&& obj) {
-        objects_.emplace_back(std::move(obj));
+        std::ostringstream out;
+        obj->Render(RenderContext(out));
+        body_ += out.str();
+    }
+
+    void Document::Reserve(size_t size) {
+        body_.reserve(size);
+    }
+
+    void Document::Render(std::string& out) const {
+        out.reserve(out.size() + body_.size() + 128);
+        out += "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"sv
+               "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">\n"sv;
+        out += body_;
+        out += "</svg>\n"sv;
     }
 
     void Document::Render(std::ostream& out) const {
-        RenderContext context(out);
-        out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"sv << std::endl
-            << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv << std::endl;
-        for (auto& object : objects_) {
-            (*object).Render(context);
-        }
-        out << "</svg>"sv << std::endl;
+        std::string text;
+        Render(text);
+        out << text;
     }
 }  // namespace svg
\ No newline at end of file
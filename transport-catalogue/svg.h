@@ -1,9 +1,12 @@
 #pragma once
 
+#include <charconv>
 #include <cstdint>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 #include <variant>
 #include <optional>
@@ -11,12 +14,33 @@
 using namespace std::literals;
 namespace svg {
 
+    namespace detail {
+        // Дописывают число в буфер в том же виде, что и operator<< потока без флагов
+        // (для double — %g с точностью 6), но без потоков и локалей
+        inline void AppendNumber(std::string& out, double value) {
+            char chars[32];
+            const auto result = std::to_chars(std::begin(chars), std::end(chars), value, std::chars_format::general, 6);
+            out.append(chars, result.ptr);
+        }
+        inline void AppendNumber(std::string& out, int value) {
+            char chars[16];
+            const auto result = std::to_chars(std::begin(chars), std::end(chars), value);
+            out.append(chars, result.ptr);
+        }
+        inline void AppendNumber(std::string& out, uint32_t value) {
+            char chars[16];
+            const auto result = std::to_chars(std::begin(chars), std::end(chars), value);
+            out.append(chars, result.ptr);
+        }
+    }
+
     enum class StrokeLineCap {
         BUTT,
         ROUND,
         SQUARE,
     };
 
+    std::string_view ToString(StrokeLineCap slc);
     std::ostream& operator<<(std::ostream& os, svg::StrokeLineCap slc);
 
     enum class StrokeLineJoin {
@@ -27,6 +51,7 @@ namespace svg {
         ROUND,
     };
 
+    std::string_view ToString(StrokeLineJoin slj);
     std::ostream& operator<<(std::ostream& os, StrokeLineJoin slj);
 
     struct Rgb {
@@ -81,31 +106,35 @@ namespace svg {
     protected:
         ~PathProps() = default;
 
-        void RenderAttrs(std::ostream& out) const {
-            using namespace std::literals;
-
+        void RenderAttrs(std::string& out) const {
             if (fill_color_) {
-                std::ostringstream strm;
-                std::visit([&strm](auto value) { PrintColor_(strm, value); }, fill_color_.value());
-                out << " fill=\""sv << strm.str() << "\""sv;
+                out += " fill=\""sv;
+                std::visit([&out](const auto& value) { PrintColor_(out, value); }, fill_color_.value());
+                out += '"';
             }
 
             if (stroke_color_) {
-                std::ostringstream strm;
-                std::visit([&strm](auto value) { PrintColor_(strm, value); } , stroke_color_.value());
-                out << " stroke=\""sv << strm.str() << "\""sv;
+                out += " stroke=\""sv;
+                std::visit([&out](const auto& value) { PrintColor_(out, value); }, stroke_color_.value());
+                out += '"';
             }
 
             if (strokeWidth_) {
-                out << " stroke-width=\""sv << *strokeWidth_ << "\""sv;
+                out += " stroke-width=\""sv;
+                detail::AppendNumber(out, *strokeWidth_);
+                out += '"';
             }
 
             if (strokeLineCap_) {
-                out << " stroke-linecap=\""sv << *strokeLineCap_ << "\""sv;
+                out += " stroke-linecap=\""sv;
+                out += ToString(*strokeLineCap_);
+                out += '"';
             }
 
             if (strokeLineJoin_) {
-                out << " stroke-linejoin=\""sv << *strokeLineJoin_ << "\""sv;
+                out += " stroke-linejoin=\""sv;
+                out += ToString(*strokeLineJoin_);
+                out += '"';
             }
         }
 
@@ -120,21 +149,31 @@ namespace svg {
         std::optional<StrokeLineCap> strokeLineCap_;
         std::optional<StrokeLineJoin> strokeLineJoin_;
 
-        inline static void PrintColor_(std::ostream& out, std::monostate) {
-            out << "none"sv;
+        inline static void PrintColor_(std::string& out, std::monostate) {
+            out += "none"sv;
         }
-        inline static void PrintColor_(std::ostream& out, std::string str) {
-            out << str;
+        inline static void PrintColor_(std::string& out, const std::string& str) {
+            out += str;
         }
-        inline static void PrintColor_(std::ostream& out, svg::Rgb rgb) {
-            out << "rgb("sv << static_cast<int>(rgb.red)
-                << ","sv << static_cast<int>(rgb.green)
-                << ","sv << static_cast<int>(rgb.blue) << ")"sv;
+        inline static void PrintColor_(std::string& out, svg::Rgb rgb) {
+            out += "rgb("sv;
+            detail::AppendNumber(out, static_cast<int>(rgb.red));
+            out += ',';
+            detail::AppendNumber(out, static_cast<int>(rgb.green));
+            out += ',';
+            detail::AppendNumber(out, static_cast<int>(rgb.blue));
+            out += ')';
         }
-        inline static void PrintColor_(std::ostream& out, svg::Rgba rgba) {
-            out << "rgba("sv << static_cast<int>(rgba.red)
-                << ","sv << static_cast<int>(rgba.green)
-                << ","sv << static_cast<int>(rgba.blue) << ","sv << rgba.opacity << ")"sv;
+        inline static void PrintColor_(std::string& out, svg::Rgba rgba) {
+            out += "rgba("sv;
+            detail::AppendNumber(out, static_cast<int>(rgba.red));
+            out += ',';
+            detail::AppendNumber(out, static_cast<int>(rgba.green));
+            out += ',';
+            detail::AppendNumber(out, static_cast<int>(rgba.blue));
+            out += ',';
+            detail::AppendNumber(out, rgba.opacity);
+            out += ')';
         }
     };
 
@@ -202,6 +241,9 @@ namespace svg {
         Circle& SetCenter(Point center);
         Circle& SetRadius(double radius);
 
+        // Дописывает тег в буфер, минуя виртуальный вызов и поток
+        void RenderTo(std::string& out) const;
+
     private:
         void RenderObject(const RenderContext& context) const override;
         Point center_;
@@ -216,6 +258,8 @@ namespace svg {
     public:
         // Добавляет очередную вершину к ломаной линии
         Polyline& AddPoint(Point point);
+
+        void RenderTo(std::string& out) const;
     private:
         void RenderObject(const RenderContext& context) const override;
         std::vector<Point> points_;
@@ -245,6 +289,8 @@ namespace svg {
         // Задаёт текстовое содержимое объекта (отображается внутри тега text)
         Text& SetData(std::string data);
 
+        void RenderTo(std::string& out) const;
+
         // Прочие данные и методы, необходимые для реализации элемента <text>
     private:
         void RenderObject(const RenderContext& context) const override;
@@ -275,14 +321,37 @@ namespace svg {
         virtual ~Drawable() = default;
     };
 
+    /*
+     * Документ сразу дописывает каждый добавленный объект в текстовый буфер:
+     * объекты не хранятся и не выделяются в куче по отдельности.
+     * Circle, Polyline и Text пишутся напрямую, прочие наследники Object — через поток
+     */
     class Document : public ObjectContainer {
     public:
+        template <typename Obj>
+        void Add(const Obj& obj) {
+            if constexpr (std::is_same_v<Obj, Circle> || std::is_same_v<Obj, Polyline> || std::is_same_v<Obj, Text>) {
+                body_.append(OBJECT_INDENT, ' ');
+                obj.RenderTo(body_);
+                body_ += '\n';
+            }
+            else {
+                ObjectContainer::Add(obj);
+            }
+        }
+
         // Добавляет в svg-документ объект-наследник svg::Object
-        void AddPtr(std::unique_ptr<Object>&& obj);
+        void AddPtr(std::unique_ptr<Object>&& obj) override;
+
+        // Резервирует место под текст объектов
+        void Reserve(size_t size);
 
         // Выводит в ostream svg-представление документа
         void Render(std::ostream& out) const;
+        // Дописывает svg-представление документа в строку
+        void Render(std::string& out) const;
     private:
-        std::vector<std::unique_ptr<Object>> objects_;
+        static constexpr int OBJECT_INDENT = 2;
+        std::string body_;
     };
-} // namespace svg
\ No newline at end of file
+} // namespace svg
@@ -0,0 +1,77 @@
+// Потоковая загрузка base_requests против загрузки через дерево json::Document
+#include "json.h"
+#include "json_reader.h"
+#include "test_support.h"
+
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+    string AnswerStreaming(const string& input_text) {
+        return tests::CaptureOutput(cout, [&] {
+            istringstream input(input_text);
+            TrCatalogue catalogue;
+            ParseJson(input, catalogue);
+        });
+    }
+
+    string AnswerFromDocument(const string& input_text) {
+        return tests::CaptureOutput(cout, [&] {
+            istringstream input(input_text);
+            TrCatalogue catalogue;
+            ParseJson(LoadJSON(input), catalogue);
+        });
+    }
+
+    void TestStreamingMatchesDocument() {
+        for (const uint64_t seed : { 1, 2, 3 }) {
+            const tests::Context context("seed "s + to_string(seed));
+            tests::NetworkOptions options;
+            options.seed = seed;
+            const string input = tests::MakeNetworkJson(options);
+            const string answers = AnswerStreaming(input);
+            CHECK(!answers.empty());
+            CHECK(answers == AnswerFromDocument(input));
+        }
+    }
+
+    void TestUnknownStopInRoadDistances() {
+        tests::NetworkOptions options;
+        options.seed = 4;
+        const string input = tests::MakeNetworkJson(options);
+        const string expected = AnswerStreaming(input);
+
+        // Расстояния до остановок, которых нет в base_requests, пропускаются
+        const json::Document document = json::Load(string_view(input));
+        json::Dict root = document.GetRoot().AsMap();
+        json::Array base_requests = root.at("base_requests"s).AsArray();
+        size_t changed = 0;
+        for (json::Node& request : base_requests) {
+            json::Dict dict = request.AsMap();
+            if (dict.at("type"s).AsString() == "Stop"s) {
+                json::Dict road_distances = dict.at("road_distances"s).AsMap();
+                road_distances.emplace("Nowhere "s + to_string(changed++), 100);
+                dict["road_distances"s] = move(road_distances);
+                request = move(dict);
+            }
+        }
+        CHECK(changed > 0);
+        root["base_requests"s] = move(base_requests);
+        ostringstream changed_input;
+        json::Print(json::Document(root), changed_input);
+
+        CHECK(AnswerStreaming(changed_input.str()) == expected);
+        CHECK(AnswerFromDocument(changed_input.str()) == expected);
+    }
+
+}  // namespace
+
+int main() {
+    return tests::RunTests({
+        { "StreamingMatchesDocument"sv, TestStreamingMatchesDocument },
+        { "UnknownStopInRoadDistances"sv, TestUnknownStopInRoadDistances },
+    });
+}
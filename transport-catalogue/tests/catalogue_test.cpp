@@ -0,0 +1,133 @@
+// Статистика маршрутов TransportCatalogue: расчёт в Finalize и обновление после него
+#include "test_support.h"
+#include "transport_catalogue.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+    using transport::core::TransportCatalogue;
+
+    // Остановки A, B, C, D на одной параллели; маршрут 1 — A-B-C-B-A, маршрут 2 — C-D-C
+    void FillCatalogue(TransportCatalogue& catalogue) {
+        catalogue.AddStop("A"s, { 55.6, 37.60 });
+        catalogue.AddStop("B"s, { 55.6, 37.61 });
+        catalogue.AddStop("C"s, { 55.6, 37.62 });
+        catalogue.AddStop("D"s, { 55.6, 37.63 });
+        catalogue.AddDistance(catalogue.FindStop("A"sv), catalogue.FindStop("B"sv), 1000);
+        catalogue.AddDistance(catalogue.FindStop("B"sv), catalogue.FindStop("C"sv), 2000);
+        catalogue.AddDistance(catalogue.FindStop("C"sv), catalogue.FindStop("B"sv), 2500);
+        catalogue.AddDistance(catalogue.FindStop("C"sv), catalogue.FindStop("D"sv), 700);
+        catalogue.AddRoute("1"s, { "A"sv, "B"sv, "C"sv, "B"sv, "A"sv }, "C"s);
+        catalogue.AddRoute("2"s, { "C"sv, "D"sv, "C"sv }, "D"s);
+    }
+
+    double GeoLength(const TransportCatalogue& catalogue, const vector<string_view>& stops) {
+        double length = 0;
+        for (size_t i = 0; i + 1 < stops.size(); ++i) {
+            length += geo::ComputeDistance(catalogue.FindStop(stops[i])->coordinates, catalogue.FindStop(stops[i + 1])->coordinates);
+        }
+        return length;
+    }
+
+    void TestStatsAfterFinalize() {
+        TransportCatalogue catalogue;
+        FillCatalogue(catalogue);
+        CHECK_THROWS(catalogue.GetRoute("1"sv), logic_error);
+        catalogue.Finalize();
+        const auto stat = catalogue.GetRoute("1"sv);
+        CHECK_EQUAL(stat.count_of_stops, size_t{ 5 });
+        CHECK_EQUAL(stat.count_of_unique_stops, size_t{ 3 });
+        // Обратного расстояния B-A нет, поэтому берётся A-B
+        CHECK_EQUAL(stat.route_length, 1000 + 2000 + 2500 + 1000);
+        const double geo_length = GeoLength(catalogue, { "A"sv, "B"sv, "C"sv, "B"sv, "A"sv });
+        CHECK(abs(stat.curvature - 6500 / geo_length) < 1e-12);
+        CHECK_EQUAL(catalogue.GetRoute("2"sv).route_length, 1400);
+    }
+
+    void TestAddDistanceAfterFinalize() {
+        TransportCatalogue catalogue;
+        FillCatalogue(catalogue);
+        catalogue.Finalize();
+        // Новое обратное расстояние меняет только маршрут, который проходит B-A
+        catalogue.AddDistance(catalogue.FindStop("B"sv), catalogue.FindStop("A"sv), 1200);
+        CHECK_EQUAL(catalogue.GetRoute("1"sv).route_length, 1000 + 2000 + 2500 + 1200);
+        CHECK_EQUAL(catalogue.GetRoute("2"sv).route_length, 1400);
+        // До этого участок D-C брал расстояние C-D
+        catalogue.AddDistance(catalogue.FindStop("D"sv), catalogue.FindStop("C"sv), 300);
+        CHECK_EQUAL(catalogue.GetRoute("2"sv).route_length, 1000);
+        // Заменённое прямое расстояние C-D
+        catalogue.AddDistance(catalogue.FindStop("C"sv), catalogue.FindStop("D"sv), 500);
+        const auto stat = catalogue.GetRoute("2"sv);
+        CHECK_EQUAL(stat.route_length, 800);
+        CHECK(abs(stat.curvature - 800 / GeoLength(catalogue, { "C"sv, "D"sv, "C"sv })) < 1e-12);
+        CHECK_EQUAL(catalogue.GetRoute("1"sv).route_length, 1000 + 2000 + 2500 + 1200);
+    }
+
+    void TestAddRouteAfterFinalize() {
+        TransportCatalogue catalogue;
+        FillCatalogue(catalogue);
+        catalogue.Finalize();
+        catalogue.AddRoute("0"s, { "B"sv, "C"sv, "B"sv }, "C"s);
+        CHECK_EQUAL(catalogue.GetRoute("0"sv).route_length, 4500);
+        vector<string> names;
+        for (const Route* route : catalogue.GetRoutesOfStop("C"sv)) {
+            names.push_back(route->name);
+        }
+        CHECK(names == vector<string>({ "0"s, "1"s, "2"s }));
+        catalogue.AddDistance(catalogue.FindStop("B"sv), catalogue.FindStop("C"sv), 100);
+        CHECK_EQUAL(catalogue.GetRoute("0"sv).route_length, 2600);
+    }
+
+    void TestRoutesWithoutSegments() {
+        TransportCatalogue catalogue;
+        FillCatalogue(catalogue);
+        catalogue.AddRoute("empty"s, vector<uint32_t>{}, 0);
+        catalogue.AddRoute("single"s, vector<uint32_t>{ 3 }, 3);
+        catalogue.Finalize();
+        const auto empty = catalogue.GetRoute("empty"sv);
+        CHECK_EQUAL(empty.count_of_stops, size_t{ 0 });
+        CHECK_EQUAL(empty.count_of_unique_stops, size_t{ 0 });
+        CHECK_EQUAL(empty.route_length, 0);
+        CHECK_EQUAL(empty.curvature, 0.0);
+        const auto single = catalogue.GetRoute("single"sv);
+        CHECK_EQUAL(single.count_of_stops, size_t{ 1 });
+        CHECK_EQUAL(single.route_length, 0);
+        CHECK_EQUAL(single.curvature, 0.0);
+        catalogue.AddDistance(catalogue.FindStop("D"sv), catalogue.FindStop("A"sv), 10);
+        CHECK_EQUAL(catalogue.GetRoute("single"sv).route_length, 0);
+    }
+
+    void TestFinalizeWithGivenStats() {
+        TransportCatalogue catalogue;
+        FillCatalogue(catalogue);
+        CHECK_THROWS(catalogue.Finalize({ TransportCatalogue::RouteStat{} }), invalid_argument);
+        // Готовая статистика не пересчитывается, а индексы строятся как обычно
+        catalogue.Finalize({ { 5, 3, 7, 1.5 }, { 3, 2, 9, 2.5 } });
+        CHECK_EQUAL(catalogue.GetRoute("1"sv).route_length, 7);
+        CHECK_EQUAL(catalogue.GetRoute("2"sv).curvature, 2.5);
+        CHECK_EQUAL(catalogue.GetRouteStats().size(), size_t{ 2 });
+        const auto routes_of_c = catalogue.GetRoutesOfStop("C"sv);
+        CHECK_EQUAL(static_cast<size_t>(routes_of_c.end() - routes_of_c.begin()), size_t{ 2 });
+        // Изменения после Finalize пересчитывают затронутые маршруты
+        catalogue.AddDistance(catalogue.FindStop("D"sv), catalogue.FindStop("C"sv), 300);
+        CHECK_EQUAL(catalogue.GetRoute("2"sv).route_length, 1000);
+        CHECK_EQUAL(catalogue.GetRoute("1"sv).route_length, 7);
+    }
+
+}  // namespace
+
+int main() {
+    return tests::RunTests({
+        { "StatsAfterFinalize"sv, TestStatsAfterFinalize },
+        { "AddDistanceAfterFinalize"sv, TestAddDistanceAfterFinalize },
+        { "AddRouteAfterFinalize"sv, TestAddRouteAfterFinalize },
+        { "RoutesWithoutSegments"sv, TestRoutesWithoutSegments },
+        { "FinalizeWithGivenStats"sv, TestFinalizeWithGivenStats },
+    });
+}
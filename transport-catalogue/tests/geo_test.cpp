@@ -0,0 +1,76 @@
+// Пакетный geo::ComputeDistances против поштучного geo::ComputeDistance
+#include "geo.h"
+#include "test_support.h"
+#include "tools/random.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+    vector<geo::Coordinates> MakePoints(size_t count, double lat_from, double lat_to) {
+        tools::Random random(42);
+        vector<geo::Coordinates> points(count);
+        for (auto& point : points) {
+            const double lat = random.Uniform(lat_from, lat_to);
+            point = { lat, random.Uniform(37.3, 37.9) };
+        }
+        return points;
+    }
+
+    vector<geo::PreparedCoordinates> Prepare(const vector<geo::Coordinates>& points) {
+        vector<geo::PreparedCoordinates> prepared;
+        for (const auto& point : points) {
+            prepared.push_back(geo::Prepare(point));
+        }
+        return prepared;
+    }
+
+    void TestPreparedDistanceIsExact() {
+        const auto points = MakePoints(10'000, 55.5, 55.9);
+        const auto prepared = Prepare(points);
+        for (size_t i = 0; i + 1 < points.size(); ++i) {
+            CHECK_EQUAL(geo::ComputeDistance(prepared[i], prepared[i + 1]), geo::ComputeDistance(points[i], points[i + 1]));
+        }
+    }
+
+    void TestBatchKernelMatchesComputeDistance() {
+        // Широты не только московские: ошибка округления растёт к полюсам
+        for (const size_t count : { 2, 3, 7, 16, 1'001, 100'003 }) {
+            for (const auto& [lat_from, lat_to] : { pair{ 55.5, 55.9 }, pair{ -60.0, 70.0 } }) {
+                const tests::Context context(to_string(count) + " points, latitude "s + to_string(lat_from)
+                                             + " .. "s + to_string(lat_to));
+                const auto points = MakePoints(count, lat_from, lat_to);
+                const auto prepared = Prepare(points);
+                vector<double> actual(count - 1);
+                geo::ComputeDistances(prepared.data(), prepared.size(), actual.data());
+                for (size_t i = 0; i + 1 < count; ++i) {
+                    const double expected = geo::ComputeDistance(points[i], points[i + 1]);
+                    if (abs(actual[i] - expected) > 1e-9 * expected) {
+                        CHECK_EQUAL(actual[i], expected);
+                    }
+                }
+            }
+        }
+    }
+
+    void TestSamePointIsZero() {
+        const auto prepared = geo::Prepare({ 55.75, 37.62 });
+        const geo::PreparedCoordinates points[] = { prepared, prepared };
+        double distance = -1;
+        geo::ComputeDistances(points, 2, &distance);
+        CHECK_EQUAL(distance, 0.0);
+        CHECK_EQUAL(geo::ComputeDistance(prepared.coordinates, prepared.coordinates), 0.0);
+    }
+
+}  // namespace
+
+int main() {
+    return tests::RunTests({
+        { "PreparedDistanceIsExact"sv, TestPreparedDistanceIsExact },
+        { "BatchKernelMatchesComputeDistance"sv, TestBatchKernelMatchesComputeDistance },
+        { "SamePointIsZero"sv, TestSamePointIsZero },
+    });
+}
@@ -0,0 +1,100 @@
+// DirectedWeightedGraph: замороженный граф в CSR против графа из AddEdge
+#include "graph.h"
+#include "test_support.h"
+#include "tools/random.h"
+
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+    using Graph = graph::DirectedWeightedGraph<double>;
+    using Edge = graph::Edge<double>;
+
+    // Вершины 0 и 3 без исходящих рёбер, чтобы в CSR были пустые отрезки
+    vector<Edge> MakeEdges(size_t vertex_count, size_t edge_count) {
+        tools::Random random(3);
+        vector<Edge> edges;
+        for (size_t i = 0; i < edge_count; ++i) {
+            graph::VertexId from = random.Index(vertex_count);
+            if (from == 0 || from == 3) {
+                from = vertex_count - 1;
+            }
+            edges.push_back({ from, random.Index(vertex_count), random.Uniform(0.0, 10.0) });
+        }
+        return edges;
+    }
+
+    bool operator==(const Edge& lhs, const Edge& rhs) {
+        return tie(lhs.from, lhs.to, lhs.weight) == tie(rhs.from, rhs.to, rhs.weight);
+    }
+
+    using IncidentEdge = tuple<graph::EdgeId, graph::VertexId, double>;
+
+    vector<IncidentEdge> CollectIncidentEdges(const Graph& graph, graph::VertexId vertex) {
+        vector<IncidentEdge> result;
+        graph.ForEachIncidentEdge(vertex, [&result](graph::EdgeId edge_id, graph::VertexId to, double weight) {
+            result.emplace_back(edge_id, to, weight);
+        });
+        return result;
+    }
+
+    void TestFrozenGraphKeepsEdges() {
+        const size_t vertex_count = 50;
+        const vector<Edge> edges = MakeEdges(vertex_count, 400);
+        Graph growing(vertex_count);
+        for (const Edge& edge : edges) {
+            growing.AddEdge(edge);
+        }
+        const Graph built(vertex_count, edges);
+        CHECK(!growing.IsFrozen());
+        CHECK(built.IsFrozen());
+
+        vector<vector<IncidentEdge>> expected(vertex_count);
+        for (graph::VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            expected[vertex] = CollectIncidentEdges(growing, vertex);
+        }
+        growing.Freeze();
+        for (const Graph* frozen : { static_cast<const Graph*>(&growing), &built }) {
+            CHECK_EQUAL(frozen->GetEdgeCount(), edges.size());
+            for (graph::EdgeId edge_id = 0; edge_id < edges.size(); ++edge_id) {
+                const tests::Context context("edge "s + to_string(edge_id));
+                CHECK(frozen->GetEdge(edge_id) == edges[edge_id]);
+            }
+            for (graph::VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+                const tests::Context context("vertex "s + to_string(vertex));
+                // Внутри вершины рёбра идут по возрастанию id, как и до заморозки
+                CHECK(CollectIncidentEdges(*frozen, vertex) == expected[vertex]);
+                const auto ids = frozen->GetIncidentEdges(vertex);
+                CHECK_EQUAL(static_cast<size_t>(ids.end() - ids.begin()), expected[vertex].size());
+            }
+            CHECK(CollectIncidentEdges(*frozen, 0).empty());
+            CHECK(CollectIncidentEdges(*frozen, 3).empty());
+            CHECK_THROWS(frozen->GetEdge(edges.size()), out_of_range);
+        }
+    }
+
+    void TestInvalidEdgesThrow() {
+        CHECK_THROWS(Graph(3, { { 0, 1, 1.0 }, { 3, 1, 1.0 } }), out_of_range);
+        CHECK_THROWS(Graph(3, { { 0, 1, 1.0 }, { 1, 3, 1.0 } }), out_of_range);
+        Graph graph(3);
+        CHECK_THROWS(graph.AddEdge({ 3, 0, 1.0 }), out_of_range);
+        CHECK_THROWS(graph.AddEdge({ 0, 3, 1.0 }), out_of_range);
+        CHECK_EQUAL(graph.AddEdge({ 0, 2, 1.0 }), graph::EdgeId{ 0 });
+        graph.Freeze();
+        CHECK_THROWS(graph.AddEdge({ 0, 1, 1.0 }), logic_error);
+        CHECK_EQUAL(graph.GetEdgeCount(), size_t{ 1 });
+    }
+
+}  // namespace
+
+int main() {
+    return tests::RunTests({
+        { "FrozenGraphKeepsEdges"sv, TestFrozenGraphKeepsEdges },
+        { "InvalidEdgesThrow"sv, TestInvalidEdgesThrow },
+    });
+}
@@ -0,0 +1,97 @@
+// json::ArenaDocument против дерева json::Node из json::Load
+#include "json.h"
+#include "json_arena.h"
+#include "test_support.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+    string MakeDocument(size_t count) {
+        string text = "{\"items\": [";
+        for (size_t i = 0; i < count; ++i) {
+            if (i > 0) {
+                text += ", ";
+            }
+            // Ключи идут не по алфавиту, чтобы проверить сортировку
+            text += "{\"name\": \"Stop "s + to_string(i) + "\", \"id\": "s + to_string(i)
+                    + ", \"lat\": "s + to_string(i) + ".25, \"flags\": [true, false, null]}"s;
+        }
+        text += "], \"escaped\": \"a\\\"b\\\\c\\nd\", \"empty\": {}, \"nothing\": []}";
+        return text;
+    }
+
+    void TestToNodeMatchesLoad() {
+        const string text = MakeDocument(100);
+        const json::ArenaDocument document{ string_view(text) };
+        CHECK(document.GetRoot().ToNode() == json::Load(string_view(text)).GetRoot());
+        istringstream stream(text);
+        CHECK(json::ArenaDocument(stream).GetRoot().ToNode() == json::Load(string_view(text)).GetRoot());
+    }
+
+    void TestSortedObjects() {
+        const string text = MakeDocument(3);
+        const json::ArenaDocument document{ string_view(text) };
+        const json::ArenaValue& root = document.GetRoot();
+        string previous;
+        for (const json::ArenaMember& member : root.AsMap()) {
+            CHECK(previous < member.key);
+            previous = string(member.key);
+        }
+        const json::ArenaValue& item = root.At("items"sv).AsArray().begin()[2];
+        CHECK_EQUAL(item.At("name"sv).AsString(), "Stop 2"sv);
+        CHECK_EQUAL(item.At("id"sv).AsInt(), 2);
+        CHECK_EQUAL(item.At("lat"sv).AsDouble(), 2.25);
+        CHECK(item.Find("missing"sv) == nullptr);
+        CHECK_THROWS(item.At("missing"sv), out_of_range);
+        CHECK(root.At("empty"sv).AsMap().begin() == root.At("empty"sv).AsMap().end());
+        CHECK(root.At("nothing"sv).AsArray().begin() == root.At("nothing"sv).AsArray().end());
+    }
+
+    void TestStringsPointIntoInput() {
+        const string text = MakeDocument(3);
+        const json::ArenaDocument document{ string_view(text) };
+        const string_view name = document.GetRoot().At("items"sv).AsArray().begin()->At("name"sv).AsString();
+        CHECK(name.data() >= text.data() && name.data() + name.size() <= text.data() + text.size());
+        // Строку с escape-последовательностями приходится раскодировать в арену
+        const string_view escaped = document.GetRoot().At("escaped"sv).AsString();
+        CHECK_EQUAL(escaped, "a\"b\\c\nd"sv);
+        CHECK(escaped.data() < text.data() || escaped.data() >= text.data() + text.size());
+    }
+
+    void TestMalformedInput() {
+        for (const string_view text : { "{\"a\": 1, \"a\": 2}"sv, "[1, 2"sv, "{\"a\": }"sv, "\"a\\qb\""sv }) {
+            const tests::Context context("input "s + string(text));
+            CHECK_THROWS(json::ArenaDocument{ text }, json::ParsingError);
+        }
+    }
+
+    void TestFewAllocations() {
+        // 10 000 объектов — это больше 70 000 узлов; дерево Node выделяет память под каждый
+        const string text = MakeDocument(10'000);
+        const size_t before_arena = tests::GetAllocationCount();
+        {
+            const json::ArenaDocument document{ string_view(text) };
+            const auto items = document.GetRoot().At("items"sv).AsArray();
+            CHECK_EQUAL(items.end() - items.begin(), 10'000);
+        }
+        const size_t arena_allocations = tests::GetAllocationCount() - before_arena;
+        const tests::Context context(to_string(arena_allocations) + " allocations"s);
+        CHECK(arena_allocations < 64);
+    }
+
+}  // namespace
+
+int main() {
+    return tests::RunTests({
+        { "ToNodeMatchesLoad"sv, TestToNodeMatchesLoad },
+        { "SortedObjects"sv, TestSortedObjects },
+        { "StringsPointIntoInput"sv, TestStringsPointIntoInput },
+        { "MalformedInput"sv, TestMalformedInput },
+        { "FewAllocations"sv, TestFewAllocations },
+    });
+}
@@ -0,0 +1,121 @@
+// json::Builder: дерево строится на месте, а сам Builder переиспользуется между ответами
+#include "json.h"
+#include "json_builder.h"
+#include "test_support.h"
+
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+    json::Node BuildBusAnswer(json::Builder& builder, int id) {
+        return builder.StartDict()
+            .Key("curvature"s).Value(1.25)
+            .Key("request_id"s).Value(id)
+            .Key("route_length"s).Value(5950)
+            .Key("stop_count"s).Value(6)
+            .Key("unique_stop_count"s).Value(5)
+            .EndDict()
+            .Build();
+    }
+
+    void TestBuildsTree() {
+        json::Builder builder;
+        const json::Node actual = builder.StartDict()
+            .Key("items"s).StartArray()
+                .Value(1)
+                .StartDict().Key("name"s).Value("Stop"s).EndDict()
+                .StartArray().EndArray()
+                .Value(nullptr)
+            .EndArray()
+            .Key("flag"s).Value(true)
+            .EndDict()
+            .Build();
+        const json::Node expected = json::Dict{
+            { "items"s, json::Array{ 1, json::Dict{ { "name"s, "Stop"s } }, json::Array{}, nullptr } },
+            { "flag"s, true },
+        };
+        CHECK(actual == expected);
+        CHECK(json::Builder{}.Value("scalar"s).Build() == json::Node("scalar"s));
+    }
+
+    void TestReuseAndReset() {
+        json::Builder builder;
+        for (int id = 1; id <= 3; ++id) {
+            const json::Node answer = BuildBusAnswer(builder, id);
+            CHECK_EQUAL(answer.AsMap().at("request_id"s).AsInt(), id);
+            CHECK_EQUAL(answer.AsMap().size(), size_t{ 5 });
+        }
+        // Недостроенное дерево отбрасывается, и Builder снова готов к работе
+        builder.StartArray().Value(1).StartDict().Key("half"s);
+        builder.Reset();
+        CHECK(builder.Value(7).Build() == json::Node(7));
+    }
+
+    void TestMisuseThrows() {
+        CHECK_THROWS(json::Builder{}.Build(), logic_error);
+        CHECK_THROWS(json::Builder{}.EndDict(), logic_error);
+        CHECK_THROWS(json::Builder{}.Key("key"s), logic_error);
+        {
+            json::Builder builder;
+            builder.StartDict();
+            CHECK_THROWS(builder.Build(), logic_error);
+            CHECK_THROWS(builder.EndArray(), logic_error);
+            builder.Key("key"s);
+            CHECK_THROWS(builder.Key("other"s), logic_error);
+            CHECK_THROWS(builder.EndDict(), logic_error);
+        }
+        {
+            json::Builder builder;
+            builder.StartArray();
+            CHECK_THROWS(builder.Key("key"s), logic_error);
+            CHECK_THROWS(builder.EndDict(), logic_error);
+        }
+        {
+            json::Builder builder;
+            builder.Value(1);
+            CHECK_THROWS(builder.Value(2), logic_error);
+            CHECK_THROWS(builder.StartDict(), logic_error);
+        }
+    }
+
+    void TestValuesAreMoved() {
+        string name(100, 'x');
+        const char* const name_data = name.data();
+        json::Array items(50, json::Node(1));
+        const json::Node* const items_data = items.data();
+        json::Builder builder;
+        const json::Node answer = builder.StartDict()
+            .Key("name"s).Value(move(name))
+            .Key("items"s).Value(move(items))
+            .EndDict()
+            .Build();
+        CHECK(answer.AsMap().at("name"s).AsString().data() == name_data);
+        CHECK(answer.AsMap().at("items"s).AsArray().data() == items_data);
+    }
+
+    void TestBusAnswerAllocations() {
+        json::Builder builder;
+        BuildBusAnswer(builder, 0);
+        const size_t before = tests::GetAllocationCount();
+        const json::Node answer = BuildBusAnswer(builder, 1);
+        const size_t allocations = tests::GetAllocationCount() - before;
+        // Узел std::map на каждый ключ плюс строка самого длинного ключа,
+        // которая не помещается в small string buffer
+        const tests::Context context(to_string(allocations) + " allocations"s);
+        CHECK(allocations <= answer.AsMap().size() + 1);
+    }
+
+}  // namespace
+
+int main() {
+    return tests::RunTests({
+        { "BuildsTree"sv, TestBuildsTree },
+        { "ReuseAndReset"sv, TestReuseAndReset },
+        { "MisuseThrows"sv, TestMisuseThrows },
+        { "ValuesAreMoved"sv, TestValuesAreMoved },
+        { "BusAnswerAllocations"sv, TestBusAnswerAllocations },
+    });
+}
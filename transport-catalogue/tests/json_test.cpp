@@ -0,0 +1,162 @@
+// Разбор JSON из непрерывного буфера: json::Load, json::ReadAll и json::Reader
+#include "json.h"
+#include "test_support.h"
+
+#include <algorithm>
+#include <climits>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+    // Поток без seek, который отдаёт данные маленькими кусками, как канал
+    class ChunkedBuffer : public streambuf {
+    public:
+        ChunkedBuffer(string data, size_t chunk_size)
+            : data_(move(data))
+            , chunk_size_(chunk_size) {
+        }
+
+    protected:
+        int_type underflow() override {
+            if (pos_ == data_.size()) {
+                return traits_type::eof();
+            }
+            const size_t size = min(chunk_size_, data_.size() - pos_);
+            char* const begin = data_.data() + pos_;
+            setg(begin, begin, begin + size);
+            pos_ += size;
+            return traits_type::to_int_type(*begin);
+        }
+
+    private:
+        string data_;
+        size_t chunk_size_;
+        size_t pos_ = 0;
+    };
+
+    string MakeBigDocument() {
+        string text = "[";
+        for (int i = 0; i < 20'000; ++i) {
+            if (i > 0) {
+                text += ", ";
+            }
+            text += "{\"name\": \"Stop "s + to_string(i) + "\", \"value\": "s + to_string(i * 7) + ".5}"s;
+        }
+        text += "]";
+        return text;
+    }
+
+    void TestStreamAndBufferAgree() {
+        const string text = MakeBigDocument();
+        CHECK(text.size() > 64 * 1024);
+        const json::Document from_buffer = json::Load(string_view(text));
+        istringstream seekable(text);
+        CHECK(json::Load(seekable) == from_buffer);
+        for (const size_t chunk_size : { 1, 7, 4096, 65'536, 100'000 }) {
+            const tests::Context context("chunk size "s + to_string(chunk_size));
+            ChunkedBuffer buffer(text, chunk_size);
+            istream pipe(&buffer);
+            CHECK(json::ReadAll(pipe) == text);
+            ChunkedBuffer buffer_again(text, chunk_size);
+            istream pipe_again(&buffer_again);
+            CHECK(json::Load(pipe_again) == from_buffer);
+        }
+        CHECK_EQUAL(from_buffer.GetRoot().AsArray().size(), size_t{ 20'000 });
+        const json::Dict& last = from_buffer.GetRoot().AsArray().back().AsMap();
+        CHECK_EQUAL(last.at("name"s).AsString(), "Stop 19999"s);
+        CHECK_EQUAL(last.at("value"s).AsDouble(), 139'993.5);
+    }
+
+    void TestChunkBoundaries() {
+        // Пробелы и спецсимволы строк попадают на каждую позицию 16-байтового блока,
+        // а конец буфера — в середину блока
+        for (size_t offset = 0; offset <= 40; ++offset) {
+            const tests::Context context("offset "s + to_string(offset));
+            const string word(offset, 'a');
+            const string text = string(offset, ' ') + "{"s + string(offset, '\n') + "\""s + word
+                                + "\\\"\\n\\t\\\\\": [\""s + word + "\", "s + to_string(offset) + "]}"s
+                                + string(offset, '\t');
+            const json::Document document = json::Load(string_view(text));
+            const json::Dict& root = document.GetRoot().AsMap();
+            CHECK_EQUAL(root.size(), size_t{ 1 });
+            CHECK_EQUAL(root.begin()->first, word + "\"\n\t\\"s);
+            const json::Array& values = root.begin()->second.AsArray();
+            CHECK_EQUAL(values.size(), size_t{ 2 });
+            CHECK_EQUAL(values[0].AsString(), word);
+            CHECK_EQUAL(values[1].AsInt(), static_cast<int>(offset));
+        }
+    }
+
+    void TestScalars() {
+        const json::Array values = json::Load(
+            "[null, true, false, 0, -17, 2147483647, -2147483648, 2147483648, 1.5, -2e3, 1E-2, \"\"]"sv)
+            .GetRoot().AsArray();
+        CHECK_EQUAL(values.size(), size_t{ 12 });
+        CHECK(values[0].IsNull());
+        CHECK(values[1].AsBool());
+        CHECK(!values[2].AsBool());
+        CHECK_EQUAL(values[3].AsInt(), 0);
+        CHECK_EQUAL(values[4].AsInt(), -17);
+        CHECK_EQUAL(values[5].AsInt(), INT_MAX);
+        CHECK_EQUAL(values[6].AsInt(), INT_MIN);
+        // Целое, не влезающее в int, становится double
+        CHECK(values[7].IsPureDouble());
+        CHECK_EQUAL(values[7].AsDouble(), 2147483648.0);
+        CHECK_EQUAL(values[8].AsDouble(), 1.5);
+        CHECK_EQUAL(values[9].AsDouble(), -2000.0);
+        CHECK_EQUAL(values[10].AsDouble(), 0.01);
+        CHECK_EQUAL(values[11].AsString(), ""s);
+    }
+
+    void TestMalformedInput() {
+        for (const string_view text : {
+                 "["sv, "[1, 2"sv, "{\"a\": 1"sv, "{\"a\" 1}"sv, "{1: 2}"sv, "\"abc"sv,
+                 "\"a\\qb\""sv, "\"line\nbreak\""sv, "tru"sv, "nul"sv, "falsy"sv,
+                 "{\"a\": 1, \"a\": 2}"sv, "]"sv, "}"sv }) {
+            const tests::Context context("input "s + string(text));
+            CHECK_THROWS(json::Load(text), json::ParsingError);
+            istringstream stream{ string(text) };
+            CHECK_THROWS(json::Load(stream), json::ParsingError);
+        }
+    }
+
+    void TestReaderMatchesLoad() {
+        const string text = "{\"base\": [1, {\"x\": \"y\"}], \"stat\": [], \"other\": {\"k\": [true, null]}}"s;
+        const json::Document expected = json::Load(string_view(text));
+        json::Reader reader{ string_view(text) };
+        reader.BeginObject();
+        string key;
+        json::Dict actual;
+        while (reader.NextKey(key)) {
+            if (key == "base"s) {
+                // Массив проходится по элементам, остальное читается целиком
+                json::Array elements;
+                reader.BeginArray();
+                while (reader.NextElement()) {
+                    elements.push_back(reader.ReadNode());
+                }
+                actual.emplace(key, move(elements));
+            }
+            else {
+                actual.emplace(key, reader.ReadNode());
+            }
+        }
+        CHECK(json::Node(move(actual)) == expected.GetRoot());
+    }
+
+}  // namespace
+
+int main() {
+    return tests::RunTests({
+        { "StreamAndBufferAgree"sv, TestStreamAndBufferAgree },
+        { "ChunkBoundaries"sv, TestChunkBoundaries },
+        { "Scalars"sv, TestScalars },
+        { "MalformedInput"sv, TestMalformedInput },
+        { "ReaderMatchesLoad"sv, TestReaderMatchesLoad },
+    });
+}
@@ -0,0 +1,116 @@
+// json::Writer печатает тот же текст, что и json::Print
+#include "json.h"
+#include "json_builder.h"
+#include "json_writer.h"
+#include "test_support.h"
+
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+    // Все виды значений, пустые и вложенные контейнеры, экранирование и разные порядки чисел
+    json::Node MakeDocument() {
+        return json::Builder{}
+            .StartDict()
+                .Key("bools"s).StartArray().Value(true).Value(false).EndArray()
+                .Key("doubles"s).StartArray()
+                    .Value(0.0).Value(0.1).Value(-2.5).Value(1e-7).Value(123456789.0).Value(3.14159265358979)
+                .EndArray()
+                .Key("empty_array"s).StartArray().EndArray()
+                .Key("empty_dict"s).StartDict().EndDict()
+                .Key("ints"s).StartArray().Value(0).Value(-17).Value(2147483647).EndArray()
+                .Key("nested"s).StartArray()
+                    .StartDict().Key("a"s).StartArray().StartArray().Value(1).EndArray().EndArray().EndDict()
+                    .StartArray().StartDict().EndDict().Value("x"s).EndArray()
+                .EndArray()
+                .Key("null"s).Value(nullptr)
+                .Key("string"s).Value("quote \" backslash \\ tab \t newline \n return \r"s)
+            .EndDict()
+            .Build();
+    }
+
+    string Print(const json::Node& node, streamsize precision = 6) {
+        ostringstream output;
+        output.precision(precision);
+        json::Print(json::Document(node), output);
+        return output.str();
+    }
+
+    void TestNodeValueMatchesPrint() {
+        const json::Node document = MakeDocument();
+        for (const streamsize precision : { 6, 10, 17 }) {
+            const tests::Context context("precision "s + to_string(precision));
+            ostringstream output;
+            output.precision(precision);
+            json::Writer(output).Value(document);
+            CHECK_EQUAL(output.str(), Print(document, precision));
+        }
+    }
+
+    // Dict печатается с ключами по алфавиту, поэтому и здесь ключи идут по алфавиту
+    void TestStreamingMatchesPrint() {
+        ostringstream output;
+        {
+            json::Writer writer(output);
+            writer.StartDict()
+                .Key("bools"sv).StartArray().Value(true).Value(false).EndArray()
+                .Key("doubles"sv).StartArray()
+                    .Value(0.0).Value(0.1).Value(-2.5).Value(1e-7).Value(123456789.0).Value(3.14159265358979)
+                .EndArray()
+                .Key("empty_array"sv).StartArray().EndArray()
+                .Key("empty_dict"sv).StartDict().EndDict()
+                .Key("ints"sv).StartArray().Value(0).Value(-17).Value(2147483647).EndArray()
+                .Key("nested"sv).StartArray()
+                    .StartDict().Key("a"sv).StartArray().StartArray().Value(1).EndArray().EndArray().EndDict()
+                    .StartArray().StartDict().EndDict().Value("x"sv).EndArray()
+                .EndArray()
+                .Key("null"sv).Value(nullptr)
+                .Key("string"sv).Value("quote \" backslash \\ tab \t newline \n return \r"sv)
+                .EndDict();
+        }
+        CHECK_EQUAL(output.str(), Print(MakeDocument()));
+    }
+
+    // Так PrintStat собирает ответы, отформатированные в других потоках
+    void TestFormattedValuesMatchPrint() {
+        const json::Node document = MakeDocument();
+        const json::Node array = json::Array{ document, json::Node(1), document };
+        ostringstream output;
+        {
+            json::Writer writer(output);
+            writer.StartArray();
+            for (const json::Node& item : array.AsArray()) {
+                ostringstream formatted;
+                json::Writer(formatted, 1).Value(item);
+                writer.FormattedValue(formatted.str());
+            }
+            writer.EndArray();
+        }
+        CHECK_EQUAL(output.str(), Print(array));
+    }
+
+    // Так серверный режим пишет ответ на пакет одной строкой
+    void TestCompactOutputParsesBack() {
+        const json::Node document = MakeDocument();
+        ostringstream output;
+        output.precision(17);
+        json::Writer(output, 0, json::Writer::Format::COMPACT).Value(document);
+        CHECK_EQUAL(output.str().find('\n'), string::npos);
+        // Целые по значению числа с плавающей точкой читаются обратно как int, поэтому
+        // сравнение идёт с разобранным выводом json::Print
+        CHECK(json::Load(output.str()) == json::Load(Print(document, 17)));
+    }
+
+}  // namespace
+
+int main() {
+    return tests::RunTests({
+        { "NodeValueMatchesPrint"sv, TestNodeValueMatchesPrint },
+        { "StreamingMatchesPrint"sv, TestStreamingMatchesPrint },
+        { "FormattedValuesMatchPrint"sv, TestFormattedValuesMatchPrint },
+        { "CompactOutputParsesBack"sv, TestCompactOutputParsesBack },
+    });
+}
@@ -0,0 +1,103 @@
+// Карта, отрисованная по индексам остановок, против эталона прежнего рендерера
+#include "json.h"
+#include "json_reader.h"
+#include "test_support.h"
+
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+    // Delta не обслуживается ни одним маршрутом и лежит далеко от остальных:
+    // если бы она участвовала в проекции, масштаб карты был бы другим
+    const string BASE_REQUESTS = R"json(
+        {"type": "Bus", "name": "14", "stops": ["Alpha", "Beta", "Gamma", "Alpha"], "is_roundtrip": true},
+        {"type": "Bus", "name": "11", "stops": ["Beta", "Gamma"], "is_roundtrip": false},
+        {"type": "Bus", "name": "2", "stops": ["Gamma", "Alpha"], "is_roundtrip": false},
+        {"type": "Stop", "name": "Alpha", "latitude": 55.61, "longitude": 37.20, "road_distances": {"Beta": 1000}},
+        {"type": "Stop", "name": "Beta", "latitude": 55.59, "longitude": 37.30, "road_distances": {"Gamma": 1500}},
+        {"type": "Stop", "name": "Gamma", "latitude": 55.57, "longitude": 37.25, "road_distances": {"Alpha": 2000}},
+        {"type": "Stop", "name": "Delta", "latitude": 56.0, "longitude": 38.0, "road_distances": {}})json";
+
+    const string SETTINGS = R"json(
+        "render_settings": {"width": 600.0, "height": 400.0, "padding": 50.0, "line_width": 14.0,
+            "stop_radius": 5.0, "bus_label_font_size": 20, "bus_label_offset": [7.0, 15.0],
+            "stop_label_font_size": 18, "stop_label_offset": [7.0, -3.0],
+            "underlayer_color": [255, 255, 255, 0.85], "underlayer_width": 3.0,
+            "color_palette": ["green", [255, 160, 0]]},
+        "routing_settings": {"bus_wait_time": 6, "bus_velocity": 40},
+        "stat_requests": [{"id": 1, "type": "Map"}])json";
+
+    // Вывод рендерера до перехода на индексы остановок для тех же base_requests
+    const string EXPECTED_MAP = R"svg(<?xml version="1.0" encoding="UTF-8" ?>
+<svg xmlns="http://www.w3.org/2000/svg" version="1.1">
+  <polyline points="550,150 300,250 550,150" fill="none" stroke="green" stroke-width="14" stroke-linecap="round" stroke-linejoin="round"/>
+  <polyline points="50,50 550,150 300,250 50,50" fill="none" stroke="rgb(255,160,0)" stroke-width="14" stroke-linecap="round" stroke-linejoin="round"/>
+  <polyline points="300,250 50,50 300,250" fill="none" stroke="green" stroke-width="14" stroke-linecap="round" stroke-linejoin="round"/>
+  <text fill="rgba(255,255,255,0.85)" stroke="rgba(255,255,255,0.85)" stroke-width="3" stroke-linecap="round" stroke-linejoin="round" x="550" y="150" dx="7" dy="15" font-size="20" font-family="Verdana" font-weight="bold">11</text>
+  <text fill="green" x="550" y="150" dx="7" dy="15" font-size="20" font-family="Verdana" font-weight="bold">11</text>
+  <text fill="rgba(255,255,255,0.85)" stroke="rgba(255,255,255,0.85)" stroke-width="3" stroke-linecap="round" stroke-linejoin="round" x="300" y="250" dx="7" dy="15" font-size="20" font-family="Verdana" font-weight="bold">11</text>
+  <text fill="green" x="300" y="250" dx="7" dy="15" font-size="20" font-family="Verdana" font-weight="bold">11</text>
+  <text fill="rgba(255,255,255,0.85)" stroke="rgba(255,255,255,0.85)" stroke-width="3" stroke-linecap="round" stroke-linejoin="round" x="50" y="50" dx="7" dy="15" font-size="20" font-family="Verdana" font-weight="bold">14</text>
+  <text fill="rgb(255,160,0)" x="50" y="50" dx="7" dy="15" font-size="20" font-family="Verdana" font-weight="bold">14</text>
+  <text fill="rgba(255,255,255,0.85)" stroke="rgba(255,255,255,0.85)" stroke-width="3" stroke-linecap="round" stroke-linejoin="round" x="300" y="250" dx="7" dy="15" font-size="20" font-family="Verdana" font-weight="bold">2</text>
+  <text fill="green" x="300" y="250" dx="7" dy="15" font-size="20" font-family="Verdana" font-weight="bold">2</text>
+  <text fill="rgba(255,255,255,0.85)" stroke="rgba(255,255,255,0.85)" stroke-width="3" stroke-linecap="round" stroke-linejoin="round" x="50" y="50" dx="7" dy="15" font-size="20" font-family="Verdana" font-weight="bold">2</text>
+  <text fill="green" x="50" y="50" dx="7" dy="15" font-size="20" font-family="Verdana" font-weight="bold">2</text>
+  <circle cx="50" cy="50" r="5" fill="white"/>
+  <circle cx="550" cy="150" r="5" fill="white"/>
+  <circle cx="300" cy="250" r="5" fill="white"/>
+  <text fill="rgba(255,255,255,0.85)" stroke="rgba(255,255,255,0.85)" stroke-width="3" stroke-linecap="round" stroke-linejoin="round" x="50" y="50" dx="7" dy="-3" font-size="18" font-family="Verdana">Alpha</text>
+  <text fill="black" x="50" y="50" dx="7" dy="-3" font-size="18" font-family="Verdana">Alpha</text>
+  <text fill="rgba(255,255,255,0.85)" stroke="rgba(255,255,255,0.85)" stroke-width="3" stroke-linecap="round" stroke-linejoin="round" x="550" y="150" dx="7" dy="-3" font-size="18" font-family="Verdana">Beta</text>
+  <text fill="black" x="550" y="150" dx="7" dy="-3" font-size="18" font-family="Verdana">Beta</text>
+  <text fill="rgba(255,255,255,0.85)" stroke="rgba(255,255,255,0.85)" stroke-width="3" stroke-linecap="round" stroke-linejoin="round" x="300" y="250" dx="7" dy="-3" font-size="18" font-family="Verdana">Gamma</text>
+  <text fill="black" x="300" y="250" dx="7" dy="-3" font-size="18" font-family="Verdana">Gamma</text>
+</svg>
+)svg";
+
+    string RenderMap(const string& extra_requests) {
+        const string output = tests::CaptureOutput(cout, [&] {
+            istringstream input("{\"base_requests\": ["s + BASE_REQUESTS + extra_requests + "],"s + SETTINGS + "}"s);
+            TrCatalogue catalogue;
+            ParseJson(input, catalogue);
+        });
+        const json::Document answers = json::Load(string_view(output));
+        return answers.GetRoot().AsArray().at(0).AsMap().at("map"s).AsString();
+    }
+
+    size_t CountOccurrences(const string& text, const string& pattern) {
+        size_t count = 0;
+        for (size_t pos = text.find(pattern); pos != string::npos; pos = text.find(pattern, pos + 1)) {
+            ++count;
+        }
+        return count;
+    }
+
+    void TestMatchesReferenceRenderer() {
+        const string map = RenderMap(""s);
+        CHECK_EQUAL(map, EXPECTED_MAP);
+        CHECK(map.find("Delta"s) == string::npos);
+    }
+
+    void TestStopsWithSharedCoordinates() {
+        // Остановка в той же точке, что и Beta, подписывается своим именем
+        const string map = RenderMap(R"json(,
+            {"type": "Stop", "name": "Beta bis", "latitude": 55.59, "longitude": 37.30, "road_distances": {"Gamma": 700}},
+            {"type": "Bus", "name": "7", "stops": ["Beta bis", "Gamma"], "is_roundtrip": false})json"s);
+        CHECK_EQUAL(CountOccurrences(map, ">Beta</text>"s), size_t{ 2 });
+        CHECK_EQUAL(CountOccurrences(map, ">Beta bis</text>"s), size_t{ 2 });
+        CHECK_EQUAL(CountOccurrences(map, "<circle cx=\"550\" cy=\"150\""s), size_t{ 2 });
+        CHECK_EQUAL(CountOccurrences(map, "<circle"s), size_t{ 4 });
+    }
+
+}  // namespace
+
+int main() {
+    return tests::RunTests({
+        { "MatchesReferenceRenderer"sv, TestMatchesReferenceRenderer },
+        { "StopsWithSharedCoordinates"sv, TestStopsWithSharedCoordinates },
+    });
+}
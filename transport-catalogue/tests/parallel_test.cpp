@@ -0,0 +1,135 @@
+// parallel::ForEachChunk и OrderedForEachChunk поверх общего пула потоков
+#include "parallel.h"
+#include "test_support.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+    void TestEveryChunkOnce() {
+        for (const size_t thread_count : { 1, 2, 4, 9 }) {
+            for (const size_t count : { 0, 1, 7, 1000 }) {
+                const tests::Context context(to_string(thread_count) + " threads, "s + to_string(count) + " items"s);
+                vector<atomic<int>> visits(count);
+                parallel::ForEachChunk(count, 3, thread_count, [&visits](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        ++visits[i];
+                    }
+                });
+                for (const auto& visit : visits) {
+                    CHECK_EQUAL(visit.load(), 1);
+                }
+
+                vector<size_t> consumed;
+                parallel::OrderedForEachChunk(count, 3, thread_count,
+                    [](size_t begin, size_t end) {
+                        vector<size_t> items;
+                        for (size_t i = begin; i < end; ++i) {
+                            items.push_back(i);
+                        }
+                        return items;
+                    },
+                    [&consumed](vector<size_t> items) {
+                        consumed.insert(consumed.end(), items.begin(), items.end());
+                    }, 2);
+                CHECK_EQUAL(consumed.size(), count);
+                for (size_t i = 0; i < consumed.size(); ++i) {
+                    CHECK_EQUAL(consumed[i], i);
+                }
+            }
+        }
+    }
+
+    // Потоки создаются при первом вызове и дальше переиспользуются: каждый новый поток
+    // один раз увеличивает счётчик, а их число не превышает размера пула
+    atomic<size_t> new_threads = 0;
+
+    void RunMarkingThreads(size_t thread_count) {
+        parallel::OrderedForEachChunk(64, 1, thread_count,
+            [](size_t, size_t) {
+                thread_local bool seen = false;
+                if (!seen) {
+                    seen = true;
+                    ++new_threads;
+                }
+                return 0;
+            },
+            [](int) {
+            });
+    }
+
+    void TestThreadsAreReused() {
+        RunMarkingThreads(4);
+        const size_t pool_size = parallel::GetSharedPool().GetThreadCount();
+        CHECK(pool_size >= 4);
+        for (int i = 0; i < 20; ++i) {
+            RunMarkingThreads(4);
+        }
+        CHECK_EQUAL(parallel::GetSharedPool().GetThreadCount(), pool_size);
+        // Плюс вызывающий поток, который может посчитать блок сам
+        CHECK(new_threads.load() <= pool_size + 1);
+    }
+
+    void TestExceptionsPropagate() {
+        CHECK_THROWS(parallel::ForEachChunk(100, 1, 4, [](size_t begin, size_t) {
+            if (begin == 50) {
+                throw runtime_error("chunk");
+            }
+        }), runtime_error);
+        CHECK_THROWS(parallel::OrderedForEachChunk(100, 1, 4,
+            [](size_t begin, size_t) {
+                if (begin == 50) {
+                    throw runtime_error("produce");
+                }
+                return begin;
+            },
+            [](size_t) {
+            }), runtime_error);
+        CHECK_THROWS(parallel::OrderedForEachChunk(100, 1, 4,
+            [](size_t begin, size_t) {
+                return begin;
+            },
+            [](size_t begin) {
+                if (begin == 10) {
+                    throw runtime_error("consume");
+                }
+            }), runtime_error);
+
+        // После исключений пул по-прежнему работает
+        atomic<size_t> sum = 0;
+        parallel::ForEachChunk(100, 1, 4, [&sum](size_t begin, size_t) {
+            sum += begin;
+        });
+        CHECK_EQUAL(sum.load(), size_t{ 4950 });
+    }
+
+    // Вызов из потока пула, когда остальные потоки заняты, не должен ждать их освобождения
+    void TestNestedCalls() {
+        atomic<size_t> total = 0;
+        parallel::OrderedForEachChunk(16, 1, 8,
+            [&total](size_t, size_t) {
+                parallel::ForEachChunk(16, 1, 8, [&total](size_t begin, size_t end) {
+                    total += end - begin;
+                });
+                return 0;
+            },
+            [](int) {
+            });
+        CHECK_EQUAL(total.load(), size_t{ 256 });
+    }
+
+}  // namespace
+
+int main() {
+    return tests::RunTests({
+        { "EveryChunkOnce"sv, TestEveryChunkOnce },
+        { "ThreadsAreReused"sv, TestThreadsAreReused },
+        { "ExceptionsPropagate"sv, TestExceptionsPropagate },
+        { "NestedCalls"sv, TestNestedCalls },
+    });
+}
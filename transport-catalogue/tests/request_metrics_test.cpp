@@ -0,0 +1,162 @@
+// Гистограмма задержек и отчёт о метриках stat_requests
+#include "json.h"
+#include "json_reader.h"
+#include "request_metrics.h"
+#include "test_support.h"
+#include "tools/random.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+    // Точный перцентиль: наименьшее значение, не меньше которого percentile процентов записей
+    uint64_t ExactPercentile(vector<uint64_t> values, double percentile) {
+        sort(values.begin(), values.end());
+        const size_t rank = static_cast<size_t>(ceil(static_cast<double>(values.size()) * percentile / 100.0));
+        return values[max<size_t>(rank, 1) - 1];
+    }
+
+    void TestSmallValuesAreExact() {
+        metrics::LatencyHistogram histogram;
+        CHECK_EQUAL(histogram.GetPercentile(50), uint64_t{ 0 });
+        CHECK_EQUAL(histogram.GetMean(), 0.0);
+        for (uint64_t value = 0; value < 32; ++value) {
+            histogram.Record(value);
+        }
+        CHECK_EQUAL(histogram.GetCount(), uint64_t{ 32 });
+        CHECK_EQUAL(histogram.GetMax(), uint64_t{ 31 });
+        CHECK_EQUAL(histogram.GetMean(), 15.5);
+        CHECK_EQUAL(histogram.GetPercentile(50), uint64_t{ 15 });
+        CHECK_EQUAL(histogram.GetPercentile(100), uint64_t{ 31 });
+        CHECK_EQUAL(histogram.GetPercentile(0), uint64_t{ 0 });
+    }
+
+    void TestPercentileError() {
+        tools::Random random(5);
+        vector<uint64_t> values;
+        metrics::LatencyHistogram histogram;
+        for (int i = 0; i < 100'000; ++i) {
+            // Задержки от наносекунд до секунд: логарифмически равномерно
+            const auto value = static_cast<uint64_t>(pow(10.0, random.Uniform(0.0, 9.5)));
+            values.push_back(value);
+            histogram.Record(value);
+        }
+        for (const double percentile : { 1.0, 50.0, 90.0, 99.0, 99.9, 100.0 }) {
+            const tests::Context context("p"s + to_string(percentile));
+            const auto expected = static_cast<double>(ExactPercentile(values, percentile));
+            const auto actual = static_cast<double>(histogram.GetPercentile(percentile));
+            // Результат — верхняя граница корзины, так что он не меньше точного значения
+            CHECK(actual >= expected);
+            CHECK(actual <= expected * (1.0 + 1.0 / 32));
+        }
+        CHECK_EQUAL(histogram.GetMax(), *max_element(values.begin(), values.end()));
+    }
+
+    void TestMergeEqualsRecordingAll() {
+        metrics::LatencyHistogram all;
+        metrics::LatencyHistogram first;
+        metrics::LatencyHistogram second;
+        for (uint64_t value = 1; value < 100'000; value = value * 3 + 1) {
+            all.Record(value);
+            (value % 2 == 0 ? first : second).Record(value);
+        }
+        first.Merge(second);
+        CHECK_EQUAL(first.GetCount(), all.GetCount());
+        CHECK_EQUAL(first.GetMax(), all.GetMax());
+        CHECK_EQUAL(first.GetMean(), all.GetMean());
+        for (const double percentile : { 10.0, 50.0, 99.0 }) {
+            CHECK_EQUAL(first.GetPercentile(percentile), all.GetPercentile(percentile));
+        }
+    }
+
+    void TestReport() {
+        metrics::RequestMetrics request_metrics;
+        request_metrics.Record(metrics::RequestType::BUS, 2'000, false);
+        request_metrics.Record(metrics::RequestType::BUS, 4'000, true);
+        request_metrics.Record(metrics::RequestType::ROUTE, 10, false);
+        CHECK(metrics::ParseRequestType("Route"sv) == metrics::RequestType::ROUTE);
+        CHECK(!metrics::ParseRequestType("Train"sv));
+
+        ostringstream output;
+        request_metrics.WriteReport(output, json::Writer::Format::COMPACT);
+        const json::Document report = json::Load(string_view(output.str()));
+        const json::Dict& types = report.GetRoot().AsMap().at("stat_requests"s).AsMap();
+        CHECK_EQUAL(types.size(), size_t{ 4 });
+        const json::Dict& bus = types.at("Bus"s).AsMap();
+        CHECK_EQUAL(bus.at("count"s).AsInt(), 2);
+        CHECK_EQUAL(bus.at("errors"s).AsInt(), 1);
+        const json::Dict& bus_latency = bus.at("latency_us"s).AsMap();
+        CHECK_EQUAL(bus_latency.at("max"s).AsDouble(), 4.0);
+        CHECK_EQUAL(bus_latency.at("mean"s).AsDouble(), 3.0);
+        CHECK(bus_latency.at("p50"s).AsDouble() >= 2.0 && bus_latency.at("p50"s).AsDouble() < 2.0 * (1.0 + 1.0 / 32));
+        CHECK_EQUAL(types.at("Stop"s).AsMap().at("count"s).AsInt(), 0);
+        const json::Dict& total = report.GetRoot().AsMap().at("total"s).AsMap();
+        CHECK_EQUAL(total.at("count"s).AsInt(), 3);
+        CHECK_EQUAL(total.at("errors"s).AsInt(), 1);
+        CHECK_EQUAL(total.at("latency_us"s).AsMap().at("max"s).AsDouble(), 4.0);
+    }
+
+    void TestReportCountsAnswers() {
+        tests::NetworkOptions options;
+        options.seed = 23;
+        options.queries = 300;
+        const json::Document network = json::Load(string_view(tests::MakeNetworkJson(options)));
+        json::Dict root = network.GetRoot().AsMap();
+        json::Dict execution_settings = root.at("execution_settings"s).AsMap();
+        execution_settings.emplace("metrics_report"s, "stderr"s);
+        root["execution_settings"s] = move(execution_settings);
+        ostringstream input_text;
+        json::Print(json::Document(root), input_text);
+
+        string answers_text;
+        const string report_text = tests::CaptureOutput(cerr, [&] {
+            answers_text = tests::CaptureOutput(cout, [&] {
+                istringstream input(input_text.str());
+                TrCatalogue catalogue;
+                ParseJson(input, catalogue);
+            });
+        });
+
+        // Ожидаемые счётчики — по самим ответам: ошибка — это ответ с error_message
+        map<int, string> request_types;
+        for (const json::Node& request : root.at("stat_requests"s).AsArray()) {
+            request_types[request.AsMap().at("id"s).AsInt()] = request.AsMap().at("type"s).AsString();
+        }
+        const json::Document answers = json::Load(string_view(answers_text));
+        map<string, pair<int, int>> expected;
+        for (const json::Node& answer : answers.GetRoot().AsArray()) {
+            auto& [count, errors] = expected[request_types.at(answer.AsMap().at("request_id"s).AsInt())];
+            ++count;
+            errors += answer.AsMap().count("error_message"s) > 0;
+        }
+        CHECK_EQUAL(expected.size(), size_t{ 4 });
+
+        const json::Document report = json::Load(string_view(report_text));
+        const json::Dict& types = report.GetRoot().AsMap().at("stat_requests"s).AsMap();
+        for (const auto& [type, counts] : expected) {
+            const tests::Context context(type);
+            CHECK_EQUAL(types.at(type).AsMap().at("count"s).AsInt(), counts.first);
+            CHECK_EQUAL(types.at(type).AsMap().at("errors"s).AsInt(), counts.second);
+        }
+        CHECK_EQUAL(report.GetRoot().AsMap().at("total"s).AsMap().at("count"s).AsInt(),
+                    static_cast<int>(request_types.size()));
+    }
+
+}  // namespace
+
+int main() {
+    return tests::RunTests({
+        { "SmallValuesAreExact"sv, TestSmallValuesAreExact },
+        { "PercentileError"sv, TestPercentileError },
+        { "MergeEqualsRecordingAll"sv, TestMergeEqualsRecordingAll },
+        { "Report"sv, TestReport },
+        { "ReportCountsAnswers"sv, TestReportCountsAnswers },
+    });
+}
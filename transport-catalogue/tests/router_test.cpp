@@ -0,0 +1,161 @@
+// Двунаправленный поиск находит те же рёбра, что и Дейкстра
+#include "json_reader.h"
+#include "test_support.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+    void LoadCatalogue(tests::NetworkOptions options, TrCatalogue& catalogue) {
+        options.with_stat_requests = false;
+        istringstream input(tests::MakeNetworkJson(options));
+        ParseJson(input, catalogue);
+    }
+
+    // Время маршрута — сумма ожиданий и поездок его участков
+    double SumItems(const OptimalRoute& route, const RoutingSettings& settings) {
+        double total = 0;
+        for (const RouteItem& item : route.items) {
+            total += settings.bus_wait_time + item.time;
+        }
+        return total;
+    }
+
+    tests::NetworkOptions Network(uint64_t seed, size_t stops, size_t buses) {
+        tests::NetworkOptions options;
+        options.seed = seed;
+        options.stops = stops;
+        options.buses = buses;
+        return options;
+    }
+
+    // Веса рёбер складываются точно, а равное время различает ключ рёбер,
+    // поэтому режимы обязаны выбрать один и тот же путь, а не просто равный по времени
+    void TestModesFindSameEdges(const tests::NetworkOptions& options) {
+        const tests::Context network_context("seed "s + to_string(options.seed) + ", "s
+                                             + to_string(options.stops) + " stops"s);
+        TrCatalogue catalogue;
+        LoadCatalogue(options, catalogue);
+
+        const RoutingSettings dijkstra_settings{ 6, 40.0 * 1000 / 60, graph::SearchMode::DIJKSTRA };
+        const RoutingSettings bidirectional_settings{ 6, 40.0 * 1000 / 60, graph::SearchMode::BIDIRECTIONAL };
+        const Transport_router dijkstra(catalogue, dijkstra_settings);
+        const Transport_router bidirectional(catalogue, bidirectional_settings);
+
+        size_t found = 0;
+        for (size_t from = 0; from < options.stops; ++from) {
+            for (size_t to = 0; to < options.stops; ++to) {
+                const string from_name = tests::StopName(from);
+                const string to_name = tests::StopName(to);
+                const tests::Context pair_context(from_name + " -> "s + to_name);
+                const auto from_idx = catalogue.FindStop(from_name)->idx;
+                const auto to_idx = catalogue.FindStop(to_name)->idx;
+                const auto expected = dijkstra.GetRouter().BuildRoute(from_idx, to_idx);
+                const auto actual = bidirectional.GetRouter().BuildRoute(from_idx, to_idx);
+                CHECK_EQUAL(actual.has_value(), expected.has_value());
+                if (!expected || !actual) {
+                    continue;
+                }
+                ++found;
+                CHECK(actual->edges == expected->edges);
+                CHECK(actual->weight == expected->weight);
+
+                const auto route = bidirectional.GetOptimalRoute(from_name, to_name);
+                CHECK(route.has_value());
+                CHECK_EQUAL(route->total_time, SumItems(*route, bidirectional_settings));
+                CHECK_EQUAL(route->total_time, dijkstra.GetOptimalRoute(from_name, to_name)->total_time);
+                CHECK(route->items.empty() || route->items.front().stop->name == from_name);
+            }
+        }
+        // Сеть должна быть достаточно связной, чтобы сравнение что-то проверяло
+        CHECK(found > options.stops * options.stops / 4);
+    }
+
+    void TestGeneratedNetworks() {
+        TestModesFindSameEdges(Network(1, 30, 12));
+        TestModesFindSameEdges(Network(2, 60, 30));
+        TestModesFindSameEdges(Network(3, 60, 30));
+        TestModesFindSameEdges(Network(4, 150, 80));
+        TestModesFindSameEdges(Network(5, 300, 160));
+    }
+
+    // Два автобуса с одинаковыми перегонами: все пути между их остановками равны по времени
+    void TestEqualTimesAreBrokenTheSameWay() {
+        TrCatalogue catalogue;
+        const vector<string_view> names = { "A"sv, "B"sv, "C"sv, "D"sv, "E"sv };
+        for (size_t i = 0; i < names.size(); ++i) {
+            catalogue.AddStop(string(names[i]), { 55.6, 37.6 + 0.01 * static_cast<double>(i) });
+        }
+        for (size_t i = 0; i + 1 < names.size(); ++i) {
+            catalogue.AddDistance(catalogue.FindStop(names[i]), catalogue.FindStop(names[i + 1]), 1000);
+        }
+        catalogue.AddRoute("1"s, { "A"sv, "B"sv, "C"sv, "D"sv, "E"sv }, "E"s);
+        catalogue.AddRoute("2"s, { "A"sv, "B"sv, "C"sv, "D"sv, "E"sv }, "E"s);
+        catalogue.AddRoute("3"s, { "B"sv, "C"sv, "D"sv }, "D"s);
+        catalogue.Finalize();
+
+        // Без ожидания пересадка ничего не стоит, и равных путей ещё больше
+        for (const int wait_time : { 0, 6 }) {
+            const RoutingSettings dijkstra_settings{ wait_time, 1000.0, graph::SearchMode::DIJKSTRA };
+            const RoutingSettings bidirectional_settings{ wait_time, 1000.0, graph::SearchMode::BIDIRECTIONAL };
+            const Transport_router dijkstra(catalogue, dijkstra_settings);
+            const Transport_router other_dijkstra(catalogue, dijkstra_settings, 2);
+            const Transport_router bidirectional(catalogue, bidirectional_settings);
+            for (const string_view from : names) {
+                for (const string_view to : names) {
+                    const tests::Context context("wait "s + to_string(wait_time) + ", "s
+                                                 + string(from) + " -> "s + string(to));
+                    const auto from_idx = catalogue.FindStop(from)->idx;
+                    const auto to_idx = catalogue.FindStop(to)->idx;
+                    const auto expected = dijkstra.GetRouter().BuildRoute(from_idx, to_idx);
+                    CHECK_EQUAL(expected.has_value(), from <= to);
+                    if (!expected) {
+                        continue;
+                    }
+                    CHECK(other_dijkstra.GetRouter().BuildRoute(from_idx, to_idx)->edges == expected->edges);
+                    CHECK(bidirectional.GetRouter().BuildRoute(from_idx, to_idx)->edges == expected->edges);
+                    // При ожидании 6 минут выгоднее ехать без пересадок
+                    if (wait_time > 0) {
+                        CHECK(expected->edges.size() == (from < to ? 1u : 0u));
+                    }
+                }
+            }
+        }
+    }
+
+    void TestUnknownStopIsNotFound() {
+        TrCatalogue catalogue;
+        LoadCatalogue(Network(1, 30, 12), catalogue);
+        for (const auto mode : { graph::SearchMode::DIJKSTRA, graph::SearchMode::BIDIRECTIONAL }) {
+            const RoutingSettings settings{ 6, 40.0, mode };
+            const Transport_router router(catalogue, settings);
+            CHECK(!router.GetOptimalRoute("Stop 0"sv, "Nowhere"sv));
+            CHECK(!router.GetOptimalRoute("Nowhere"sv, "Stop 0"sv));
+        }
+    }
+
+    void TestUnknownSearchModeIsRejected() {
+        for (const string& search_mode : { "Dijkstra"s, "bidirectonal"s, "contraction_hierarchies"s, ""s }) {
+            const tests::Context context("search_mode \""s + search_mode + "\""s);
+            tests::NetworkOptions options = Network(1, 30, 12);
+            options.search_mode = search_mode;
+            TrCatalogue catalogue;
+            CHECK_THROWS(LoadCatalogue(options, catalogue), invalid_argument);
+        }
+    }
+
+}  // namespace
+
+int main() {
+    return tests::RunTests({
+        { "ModesFindSameEdges"sv, TestGeneratedNetworks },
+        { "EqualTimesAreBrokenTheSameWay"sv, TestEqualTimesAreBrokenTheSameWay },
+        { "UnknownStopIsNotFound"sv, TestUnknownStopIsNotFound },
+        { "UnknownSearchModeIsRejected"sv, TestUnknownSearchModeIsRejected },
+    });
+}
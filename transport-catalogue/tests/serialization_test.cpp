@@ -0,0 +1,239 @@
+// Снимок базы и индекс маршрутизатора: сохранение, загрузка и отказ от повреждённых файлов
+#include "json_reader.h"
+#include "serialization.h"
+#include "test_support.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+    namespace fs = std::filesystem;
+
+    string ReadFile(const string& path) {
+        ifstream input(path, ios::binary);
+        return string(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+    }
+
+    void WriteFile(const string& path, const string& data) {
+        ofstream output(path, ios::binary | ios::trunc);
+        output.write(data.data(), static_cast<streamsize>(data.size()));
+    }
+
+    void FlipByte(const string& path, size_t position) {
+        string data = ReadFile(path);
+        CHECK(position < data.size());
+        data[position] = static_cast<char>(data[position] ^ 0x5a);
+        WriteFile(path, data);
+    }
+
+    // Каталог для файлов одного теста, удаляется вместе с объектом
+    class TempDirectory {
+    public:
+        explicit TempDirectory(const string& name)
+            : path_(fs::temp_directory_path() / ("transport_catalogue_"s + name)) {
+            fs::remove_all(path_);
+            fs::create_directories(path_);
+        }
+        TempDirectory(const TempDirectory&) = delete;
+        TempDirectory& operator=(const TempDirectory&) = delete;
+        ~TempDirectory() {
+            fs::remove_all(path_);
+        }
+
+        string GetFile(const string& name) const {
+            return (path_ / name).string();
+        }
+
+    private:
+        fs::path path_;
+    };
+
+    tests::NetworkOptions MakeOptions(const string& search_mode, const string& file, uint64_t seed = 5) {
+        tests::NetworkOptions options;
+        options.seed = seed;
+        options.stops = 60;
+        options.buses = 30;
+        options.queries = 300;
+        options.search_mode = search_mode;
+        options.serialization_file = file;
+        return options;
+    }
+
+    void MakeBase(tests::NetworkOptions options) {
+        options.with_stat_requests = false;
+        istringstream input(tests::MakeNetworkJson(options));
+        ::MakeBase(input);
+    }
+
+    // Ответы process_requests; сообщения о перестроении индекса проверяются через LoadSnapshot
+    string ProcessRequests(tests::NetworkOptions options) {
+        options.with_base_requests = false;
+        return tests::CaptureOutput(cout, [&] {
+            tests::CaptureOutput(cerr, [&] {
+                istringstream input(tests::MakeNetworkJson(options));
+                ::ProcessRequests(input);
+            });
+        });
+    }
+
+    // Ответы обычного запуска, где база и запросы приходят в одном JSON
+    string Answer(tests::NetworkOptions options) {
+        options.serialization_file.clear();
+        return tests::CaptureOutput(cout, [&] {
+            istringstream input(tests::MakeNetworkJson(options));
+            TrCatalogue catalogue;
+            ParseJson(input, catalogue);
+        });
+    }
+
+    // Загружает снимок и возвращает то, что serialization::LoadBase написал в cerr
+    string LoadSnapshot(const string& path, serialization::TransportBase& base) {
+        return tests::CaptureOutput(cerr, [&] {
+            serialization::LoadBase(path, base);
+        });
+    }
+
+    void TestRoundTripAnswersMatchSingleRun(const string& search_mode) {
+        const TempDirectory directory("round_trip");
+        const tests::NetworkOptions options = MakeOptions(search_mode, directory.GetFile("base.db"));
+        MakeBase(options);
+        CHECK(fs::exists(serialization::GetRouterIndexPath(options.serialization_file)));
+
+        serialization::TransportBase base;
+        CHECK_EQUAL(LoadSnapshot(options.serialization_file, base), ""s);
+        CHECK_EQUAL(base.catalogue.GetStopsCount(), options.stops);
+        CHECK_EQUAL(base.catalogue.GetAllBuses().size(), options.buses);
+        CHECK(base.router.has_value());
+        CHECK(base.router->GetRouter().GetSearchMode() == base.routing_settings.search_mode);
+
+        CHECK(ProcessRequests(options) == Answer(options));
+    }
+
+    // Статистика маршрутов и граф берутся из файлов как есть и совпадают с построенными заново
+    void TestLoadedBaseMatchesBuiltOne(const string& search_mode) {
+        const TempDirectory directory("loaded_base");
+        tests::NetworkOptions options = MakeOptions(search_mode, directory.GetFile("base.db"));
+        MakeBase(options);
+        serialization::TransportBase base;
+        CHECK_EQUAL(LoadSnapshot(options.serialization_file, base), ""s);
+
+        options.with_stat_requests = false;
+        options.serialization_file.clear();
+        istringstream input(tests::MakeNetworkJson(options));
+        TrCatalogue catalogue;
+        ParseJson(input, catalogue);
+        const Transport_router router(catalogue, base.routing_settings);
+
+        const auto& loaded_stats = base.catalogue.GetRouteStats();
+        const auto& built_stats = catalogue.GetRouteStats();
+        CHECK_EQUAL(loaded_stats.size(), built_stats.size());
+        for (size_t i = 0; i < min(loaded_stats.size(), built_stats.size()); ++i) {
+            const tests::Context context("route "s + to_string(i));
+            CHECK_EQUAL(loaded_stats[i].count_of_stops, built_stats[i].count_of_stops);
+            CHECK_EQUAL(loaded_stats[i].count_of_unique_stops, built_stats[i].count_of_unique_stops);
+            CHECK_EQUAL(loaded_stats[i].route_length, built_stats[i].route_length);
+            CHECK_EQUAL(loaded_stats[i].curvature, built_stats[i].curvature);
+        }
+
+        const Transport_router::Graph& loaded_graph = base.router->GetGraph();
+        const Transport_router::Graph& built_graph = router.GetGraph();
+        CHECK(loaded_graph.IsFrozen());
+        CHECK_EQUAL(loaded_graph.GetVertexCount(), built_graph.GetVertexCount());
+        CHECK_EQUAL(loaded_graph.GetEdgeCount(), built_graph.GetEdgeCount());
+        const size_t edge_count = min(loaded_graph.GetEdgeCount(), built_graph.GetEdgeCount());
+        for (graph::EdgeId edge_id = 0; edge_id < edge_count; ++edge_id) {
+            const tests::Context context("edge "s + to_string(edge_id));
+            const auto loaded = loaded_graph.GetEdge(edge_id);
+            const auto built = built_graph.GetEdge(edge_id);
+            CHECK_EQUAL(loaded.from, built.from);
+            CHECK_EQUAL(loaded.to, built.to);
+            CHECK(loaded.weight == built.weight);
+        }
+    }
+
+    void TestCorruptedSnapshotIsRejected(const string& search_mode) {
+        const TempDirectory directory("corrupted_snapshot");
+        const tests::NetworkOptions options = MakeOptions(search_mode, directory.GetFile("base.db"));
+        MakeBase(options);
+        const string& path = options.serialization_file;
+        const string original = ReadFile(path);
+
+        // Магия, размер в заголовке, середина и конец полезной нагрузки
+        for (const size_t position : { size_t{ 0 }, size_t{ 20 }, original.size() / 2, original.size() - 1 }) {
+            const tests::Context context("byte "s + to_string(position));
+            WriteFile(path, original);
+            FlipByte(path, position);
+            serialization::TransportBase base;
+            CHECK_THROWS(LoadSnapshot(path, base), serialization::SnapshotError);
+        }
+
+        WriteFile(path, original.substr(0, original.size() - 1));
+        serialization::TransportBase truncated;
+        CHECK_THROWS(LoadSnapshot(path, truncated), serialization::SnapshotError);
+
+        WriteFile(path, original.substr(0, 10));
+        serialization::TransportBase header_only;
+        CHECK_THROWS(LoadSnapshot(path, header_only), serialization::SnapshotError);
+    }
+
+    void TestCorruptedRouterIndexIsRebuilt(const string& search_mode) {
+        const TempDirectory directory("corrupted_router_index");
+        const tests::NetworkOptions options = MakeOptions(search_mode, directory.GetFile("base.db"));
+        MakeBase(options);
+        const string index_path = serialization::GetRouterIndexPath(options.serialization_file);
+        const string expected = Answer(options);
+
+        FlipByte(index_path, ReadFile(index_path).size() / 2);
+        serialization::TransportBase base;
+        CHECK(LoadSnapshot(options.serialization_file, base).find("Router index is ignored"s) != string::npos);
+        CHECK(base.router.has_value());
+        CHECK(ProcessRequests(options) == expected);
+
+        fs::remove(index_path);
+        serialization::TransportBase without_index;
+        CHECK(LoadSnapshot(options.serialization_file, without_index).find("Router index is ignored"s) != string::npos);
+        CHECK(ProcessRequests(options) == expected);
+    }
+
+    void TestRouterIndexOfAnotherBaseIsRebuilt(const string& search_mode) {
+        const TempDirectory directory("another_router_index");
+        const tests::NetworkOptions options = MakeOptions(search_mode, directory.GetFile("base.db"));
+        const tests::NetworkOptions other = MakeOptions(search_mode, directory.GetFile("other.db"), 6);
+        MakeBase(options);
+        MakeBase(other);
+        fs::copy_file(serialization::GetRouterIndexPath(other.serialization_file),
+                      serialization::GetRouterIndexPath(options.serialization_file),
+                      fs::copy_options::overwrite_existing);
+
+        serialization::TransportBase base;
+        CHECK(LoadSnapshot(options.serialization_file, base).find("different base"s) != string::npos);
+        CHECK(ProcessRequests(options) == Answer(options));
+    }
+
+    // Каждый тест выполняется во всех режимах поиска: индекс маршрутизатора у них разный
+    template <void (*Test)(const string&)>
+    void ForEachSearchMode() {
+        for (const string& search_mode : tests::SEARCH_MODES) {
+            const tests::Context context(search_mode);
+            Test(search_mode);
+        }
+    }
+
+}  // namespace
+
+int main() {
+    return tests::RunTests({
+        { "RoundTripAnswersMatchSingleRun"sv, ForEachSearchMode<TestRoundTripAnswersMatchSingleRun> },
+        { "LoadedBaseMatchesBuiltOne"sv, ForEachSearchMode<TestLoadedBaseMatchesBuiltOne> },
+        { "CorruptedSnapshotIsRejected"sv, ForEachSearchMode<TestCorruptedSnapshotIsRejected> },
+        { "CorruptedRouterIndexIsRebuilt"sv, ForEachSearchMode<TestCorruptedRouterIndexIsRebuilt> },
+        { "RouterIndexOfAnotherBaseIsRebuilt"sv, ForEachSearchMode<TestRouterIndexOfAnotherBaseIsRebuilt> },
+    });
+}
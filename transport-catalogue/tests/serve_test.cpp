@@ -0,0 +1,116 @@
+// Серверный режим: ответы на пакеты совпадают с обычным запуском, ошибки не останавливают сервер
+#include "json_reader.h"
+#include "json_writer.h"
+#include "test_support.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+    string Answer(const tests::NetworkOptions& options) {
+        return tests::CaptureOutput(cout, [&] {
+            istringstream input(tests::MakeNetworkJson(options));
+            TrCatalogue catalogue;
+            ParseJson(input, catalogue);
+        });
+    }
+
+    vector<string> Serve(const tests::NetworkOptions& options, const vector<string>& batches) {
+        tests::NetworkOptions settings_options = options;
+        settings_options.with_stat_requests = false;
+        istringstream settings(tests::MakeNetworkJson(settings_options));
+        string input;
+        for (const string& batch : batches) {
+            input += batch + "\n"s;
+        }
+        istringstream batches_input(input);
+        ostringstream output;
+        ServeRequests(settings, batches_input, output);
+
+        vector<string> lines;
+        istringstream lines_input(output.str());
+        for (string line; getline(lines_input, line);) {
+            lines.push_back(move(line));
+        }
+        return lines;
+    }
+
+    // stat_requests входного JSON одной строкой, как пакет построчного протокола
+    string MakeBatch(const tests::NetworkOptions& options) {
+        const json::Document document = json::Load(tests::MakeNetworkJson(options));
+        ostringstream batch;
+        json::Writer(batch, 0, json::Writer::Format::COMPACT)
+            .StartDict()
+            .Key("stat_requests"sv).Value(document.GetRoot().AsMap().at("stat_requests"s))
+            .EndDict();
+        return batch.str();
+    }
+
+    tests::NetworkOptions MakeOptions(const string& search_mode, size_t queries) {
+        tests::NetworkOptions options;
+        options.seed = 11;
+        options.stops = 80;
+        options.buses = 40;
+        options.queries = queries;
+        options.search_mode = search_mode;
+        return options;
+    }
+
+    void TestServeAnswersMatchSingleRun() {
+        for (const string& search_mode : tests::SEARCH_MODES) {
+            const tests::Context context(search_mode);
+            tests::NetworkOptions options = MakeOptions(search_mode, 300);
+            const json::Document expected = json::Load(Answer(options));
+            options.thread_count = 4;
+            const vector<string> lines = Serve(options, { MakeBatch(options), ""s, MakeBatch(options) });
+            CHECK_EQUAL(lines.size(), 2u);
+            CHECK(lines[0] == lines[1]);
+            CHECK(json::Load(lines[0]) == expected);
+        }
+    }
+
+    void TestServeErrorLines() {
+        tests::NetworkOptions options;
+        options.stops = 20;
+        options.buses = 8;
+        const vector<string> lines = Serve(options, {
+            "not json"s,
+            R"({"stat_requests": [)"s,
+            R"({"stat_requests": 5})"s,
+            R"({"stat_requests": [{"id": "x"}]})"s,
+            R"({"stat_requests": [{"id": 1}]})"s,
+            R"({"command": "bogus"})"s,
+            R"({"command": "metrics"})"s,
+            R"({"stat_requests": [{"id": 2, "type": "Route", "from": "Nowhere", "to": "Stop 0"}]})"s,
+            R"({"stat_requests": [{"id": 3, "type": "Bus", "name": "Nowhere"}]})"s,
+            R"({"stat_requests": []})"s,
+        });
+        // Ошибочный пакет не останавливает сервер: на каждую строку есть ответ
+        CHECK_EQUAL(lines.size(), 10u);
+        for (size_t i = 0; i < 7; ++i) {
+            const tests::Context context(lines[i]);
+            const json::Document document = json::Load(lines[i]);
+            CHECK(document.GetRoot().IsMap());
+            CHECK(!document.GetRoot().AsMap().at("error_message"s).AsString().empty());
+        }
+        CHECK_EQUAL(lines[2], R"({"error_message":"stat_requests must be an array"})"s);
+        CHECK_EQUAL(lines[3], R"({"error_message":"Field id of stat request must be an integer"})"s);
+        CHECK_EQUAL(lines[5], R"({"error_message":"Unknown command bogus"})"s);
+        CHECK_EQUAL(lines[6], R"({"error_message":"Metrics are disabled: set execution_settings.metrics_report"})"s);
+        CHECK_EQUAL(lines[7], R"([{"error_message":"not found","request_id":2}])"s);
+        CHECK_EQUAL(lines[8], R"([{"error_message":"not found","request_id":3}])"s);
+        CHECK_EQUAL(lines[9], "[]"s);
+    }
+
+}  // namespace
+
+int main() {
+    return tests::RunTests({
+        { "ServeAnswersMatchSingleRun"sv, TestServeAnswersMatchSingleRun },
+        { "ServeErrorLines"sv, TestServeErrorLines },
+    });
+}
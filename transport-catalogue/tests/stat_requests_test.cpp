@@ -0,0 +1,51 @@
+// Параллельные ответы на stat_requests совпадают с последовательными
+#include "json_reader.h"
+#include "test_support.h"
+
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+    string Answer(const tests::NetworkOptions& options) {
+        return tests::CaptureOutput(cout, [&] {
+            istringstream input(tests::MakeNetworkJson(options));
+            TrCatalogue catalogue;
+            ParseJson(input, catalogue);
+        });
+    }
+
+    tests::NetworkOptions MakeOptions(const string& search_mode, size_t queries) {
+        tests::NetworkOptions options;
+        options.seed = 11;
+        options.stops = 80;
+        options.buses = 40;
+        options.queries = queries;
+        options.search_mode = search_mode;
+        return options;
+    }
+
+    void TestParallelOutputEqualsSerial() {
+        for (const string& search_mode : tests::SEARCH_MODES) {
+            const tests::Context context(search_mode);
+            // Несколько блоков по STAT_CHUNK_SIZE запросов, чтобы порядок сборки имел значение
+            tests::NetworkOptions options = MakeOptions(search_mode, 1500);
+            const string serial = Answer(options);
+            CHECK(!serial.empty());
+            for (const int thread_count : { 2, 4, 0 }) {
+                const tests::Context threads_context("thread_count "s + to_string(thread_count));
+                options.thread_count = thread_count;
+                CHECK(Answer(options) == serial);
+            }
+        }
+    }
+
+}  // namespace
+
+int main() {
+    return tests::RunTests({
+        { "ParallelOutputEqualsSerial"sv, TestParallelOutputEqualsSerial },
+    });
+}
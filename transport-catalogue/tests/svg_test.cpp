@@ -0,0 +1,109 @@
+// svg::Document пишет объекты прямо в строку через to_chars; вывод сверяется
+// с эталоном, напечатанным прежней реализацией через operator<< потока
+#include "svg.h"
+#include "test_support.h"
+#include "tools/random.h"
+
+#include <cmath>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+    // Наследник Object вне Circle/Polyline/Text рисуется через виртуальный RenderObject
+    class Marker : public svg::Object {
+        void RenderObject(const svg::RenderContext& context) const override {
+            context.out << "<marker id=\"m\"/>";
+        }
+    };
+
+    const string EXPECTED_DOCUMENT = R"svg(<?xml version="1.0" encoding="UTF-8" ?>
+<svg xmlns="http://www.w3.org/2000/svg" version="1.1">
+  <circle cx="0.333333" cy="-2e-07" r="1e+07" fill="rgba(1,2,3,0.333333)" stroke="red" stroke-width="2.5" stroke-linecap="square" stroke-linejoin="miter-clip"/>
+  <marker id="m"/>
+  <polyline points="0,0 123456,1.23457e+06 -0.000123457,100" fill="none" stroke="rgb(255,0,7)" stroke-linejoin="arcs"/>
+  <polyline points=""/>
+  <text fill="none" stroke-linecap="butt" stroke-linejoin="bevel" x="35" y="20" dx="0.5" dy="-0.001" font-size="4000000000" font-family="Verdana">Tom & Jerry</text>
+  <text stroke-linecap="round" stroke-linejoin="round" x="0" y="0" dx="0" dy="0" font-size="1" font-weight="bold">plain</text>
+</svg>
+)svg";
+
+    svg::Document MakeDocument() {
+        using namespace svg;
+        Document doc;
+        // Крайние случаи формата: доли, экспоненты, округление до 6 значащих цифр, все цвета
+        doc.Add(Circle().SetCenter({ 1.0 / 3, -2e-7 }).SetRadius(1e7)
+            .SetFillColor(Rgba(1, 2, 3, 0.333333333)).SetStrokeColor("red"s).SetStrokeWidth(2.5)
+            .SetStrokeLineCap(StrokeLineCap::SQUARE).SetStrokeLineJoin(StrokeLineJoin::MITER_CLIP));
+        doc.Add(Marker());
+        doc.Add(Polyline().AddPoint({ 0, 0 }).AddPoint({ 123456.5, 1234567 }).AddPoint({ -0.000123456789, 99.99999 })
+            .SetFillColor(NoneColor).SetStrokeColor(Rgb(255, 0, 7)).SetStrokeLineJoin(StrokeLineJoin::ARCS));
+        doc.Add(Polyline());
+        doc.Add(Text().SetPosition({ 35, 20 }).SetOffset({ 0.5, -1e-3 }).SetFontSize(4'000'000'000u)
+            .SetFontFamily("Verdana"s).SetData("Tom & Jerry"s).SetFillColor(Color{})
+            .SetStrokeLineCap(StrokeLineCap::BUTT).SetStrokeLineJoin(StrokeLineJoin::BEVEL));
+        doc.Add(Text().SetData("plain"s).SetFontWeight("bold"s)
+            .SetStrokeLineCap(StrokeLineCap::ROUND).SetStrokeLineJoin(StrokeLineJoin::ROUND));
+        return doc;
+    }
+
+    string StreamNumber(double value) {
+        ostringstream out;
+        out << value;
+        return out.str();
+    }
+
+    void TestNumbersMatchStream() {
+        tools::Random random(17);
+        for (const double value : { 0.0, -0.0, 1.0, -1.0, 0.1 + 0.2, 1.0 / 3, 123456.5, 999999.5, 1e-5, 1e-4,
+                                    1e15, 1e16, 2.5e-300, 1.7e308, 5e-324 }) {
+            string actual;
+            svg::detail::AppendNumber(actual, value);
+            CHECK_EQUAL(actual, StreamNumber(value));
+        }
+        for (int i = 0; i < 100'000; ++i) {
+            // Мантисса и порядок случайны, чтобы попасть и в фиксированную, и в экспоненциальную запись
+            const double value = random.Uniform(-1.0, 1.0) * pow(10.0, random.Uniform(-12.0, 12.0));
+            string actual;
+            svg::detail::AppendNumber(actual, value);
+            if (actual != StreamNumber(value)) {
+                CHECK_EQUAL(actual, StreamNumber(value));
+            }
+        }
+        for (const int value : { 0, -1, 255, -2147483647 - 1, 2147483647 }) {
+            string actual;
+            svg::detail::AppendNumber(actual, value);
+            CHECK_EQUAL(actual, to_string(value));
+        }
+        string actual;
+        svg::detail::AppendNumber(actual, uint32_t{ 4'000'000'000 });
+        CHECK_EQUAL(actual, "4000000000"s);
+    }
+
+    void TestDocumentMatchesStreamRenderer() {
+        string actual;
+        MakeDocument().Render(actual);
+        CHECK_EQUAL(actual, EXPECTED_DOCUMENT);
+    }
+
+    void TestStreamAndStringAgree() {
+        const svg::Document doc = MakeDocument();
+        ostringstream stream;
+        doc.Render(stream);
+        // Render в строку дописывает, а не перезаписывает
+        string text = "prefix"s;
+        doc.Render(text);
+        CHECK_EQUAL("prefix"s + stream.str(), text);
+    }
+
+}  // namespace
+
+int main() {
+    return tests::RunTests({
+        { "NumbersMatchStream"sv, TestNumbersMatchStream },
+        { "DocumentMatchesStreamRenderer"sv, TestDocumentMatchesStreamRenderer },
+        { "StreamAndStringAgree"sv, TestStreamAndStringAgree },
+    });
+}
@@ -0,0 +1,267 @@
+#include "test_support.h"
+#include "json_writer.h"
+#include "tools/random.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace tests {
+
+    namespace {
+
+        atomic<size_t> allocation_count{ 0 };
+
+        // Описания активных объектов Context, от внешнего к внутреннему
+        vector<string>& GetContexts() {
+            static vector<string> contexts;
+            return contexts;
+        }
+
+        struct Bus {
+            vector<size_t> stops;
+            bool is_roundtrip = false;
+        };
+
+        string BusName(size_t bus) {
+            return "Bus "s + to_string(bus);
+        }
+
+        vector<Bus> MakeBuses(const NetworkOptions& options, tools::Random& random) {
+            vector<Bus> buses;
+            for (size_t i = 0; i < options.buses; ++i) {
+                Bus bus;
+                bus.is_roundtrip = random.Chance(0.4);
+                // Общий отрезок с уже созданным маршрутом даёт параллельные рёбра одинакового веса
+                if (i > 0 && random.Chance(0.3)) {
+                    const vector<size_t>& other = buses[random.Index(i)].stops;
+                    const size_t begin = random.Index(other.size());
+                    const size_t length = 1 + random.Index(other.size() - begin);
+                    bus.stops.assign(other.begin() + begin, other.begin() + begin + length);
+                }
+                const size_t stop_count = 2 + random.Index(7);
+                while (bus.stops.size() < stop_count) {
+                    const size_t stop = random.Index(options.stops);
+                    if (bus.stops.empty() || bus.stops.back() != stop) {
+                        bus.stops.push_back(stop);
+                    }
+                }
+                if (bus.is_roundtrip && bus.stops.back() != bus.stops.front()) {
+                    bus.stops.push_back(bus.stops.front());
+                }
+                buses.push_back(move(bus));
+            }
+            return buses;
+        }
+
+        // Расстояния задаются в направлении движения; обратное направление — лишь иногда
+        map<pair<size_t, size_t>, int> MakeDistances(const vector<Bus>& buses, tools::Random& random) {
+            map<pair<size_t, size_t>, int> distances;
+            for (const Bus& bus : buses) {
+                for (size_t i = 1; i < bus.stops.size(); ++i) {
+                    const size_t from = bus.stops[i - 1];
+                    const size_t to = bus.stops[i];
+                    distances.emplace(pair{ from, to }, 200 + 100 * static_cast<int>(random.Index(29)));
+                    if (random.Chance(0.3)) {
+                        distances.emplace(pair{ to, from }, 200 + 100 * static_cast<int>(random.Index(29)));
+                    }
+                }
+            }
+            return distances;
+        }
+
+        void WriteBaseRequests(json::Writer& writer, const NetworkOptions& options, const vector<Bus>& buses
+            , const map<pair<size_t, size_t>, int>& distances, const vector<pair<double, double>>& coordinates) {
+            writer.Key("base_requests"sv).StartArray();
+            auto distance = distances.begin();
+            for (size_t stop = 0; stop < options.stops; ++stop) {
+                writer.StartDict()
+                    .Key("type"sv).Value("Stop"sv)
+                    .Key("name"sv).Value(string_view(StopName(stop)))
+                    .Key("latitude"sv).Value(coordinates[stop].first)
+                    .Key("longitude"sv).Value(coordinates[stop].second)
+                    .Key("road_distances"sv).StartDict();
+                for (; distance != distances.end() && distance->first.first == stop; ++distance) {
+                    writer.Key(StopName(distance->first.second)).Value(distance->second);
+                }
+                writer.EndDict().EndDict();
+            }
+            for (size_t i = 0; i < buses.size(); ++i) {
+                writer.StartDict()
+                    .Key("type"sv).Value("Bus"sv)
+                    .Key("name"sv).Value(string_view(BusName(i)))
+                    .Key("is_roundtrip"sv).Value(buses[i].is_roundtrip)
+                    .Key("stops"sv).StartArray();
+                for (const size_t stop : buses[i].stops) {
+                    writer.Value(string_view(StopName(stop)));
+                }
+                writer.EndArray().EndDict();
+            }
+            writer.EndArray();
+        }
+
+        void WriteSettings(json::Writer& writer, const NetworkOptions& options) {
+            writer.Key("render_settings"sv).StartDict()
+                .Key("width"sv).Value(600.0)
+                .Key("height"sv).Value(400.0)
+                .Key("padding"sv).Value(50.0)
+                .Key("line_width"sv).Value(14.0)
+                .Key("stop_radius"sv).Value(5.0)
+                .Key("bus_label_font_size"sv).Value(20)
+                .Key("bus_label_offset"sv).StartArray().Value(7.0).Value(15.0).EndArray()
+                .Key("stop_label_font_size"sv).Value(20)
+                .Key("stop_label_offset"sv).StartArray().Value(7.0).Value(-3.0).EndArray()
+                .Key("underlayer_color"sv).StartArray().Value(255).Value(255).Value(255).Value(0.85).EndArray()
+                .Key("underlayer_width"sv).Value(3.0)
+                .Key("color_palette"sv).StartArray()
+                    .Value("green"sv)
+                    .StartArray().Value(255).Value(160).Value(0).EndArray()
+                    .Value("red"sv)
+                .EndArray()
+                .EndDict();
+            writer.Key("routing_settings"sv).StartDict()
+                .Key("bus_wait_time"sv).Value(6)
+                .Key("bus_velocity"sv).Value(40.0)
+                .Key("search_mode"sv).Value(string_view(options.search_mode))
+                .EndDict();
+            writer.Key("execution_settings"sv).StartDict()
+                .Key("thread_count"sv).Value(options.thread_count)
+                .EndDict();
+            if (!options.serialization_file.empty()) {
+                writer.Key("serialization_settings"sv).StartDict()
+                    .Key("file"sv).Value(string_view(options.serialization_file))
+                    .EndDict();
+            }
+        }
+
+        // Первый запрос — карта, дальше Bus, Stop и Route вперемешку
+        void WriteStatRequests(json::Writer& writer, const NetworkOptions& options, tools::Random& random) {
+            writer.Key("stat_requests"sv).StartArray();
+            writer.StartDict().Key("id"sv).Value(1).Key("type"sv).Value("Map"sv).EndDict();
+            for (size_t id = 2; id <= options.queries; ++id) {
+                writer.StartDict().Key("id"sv).Value(static_cast<int>(id));
+                const bool missing = random.Chance(0.05);
+                switch (random.Index(4)) {
+                case 0:
+                    writer.Key("type"sv).Value("Bus"sv)
+                        .Key("name"sv).Value(string_view(missing ? "Missing bus"s : BusName(random.Index(options.buses))));
+                    break;
+                case 1:
+                    writer.Key("type"sv).Value("Stop"sv)
+                        .Key("name"sv).Value(string_view(missing ? "Missing stop"s : StopName(random.Index(options.stops))));
+                    break;
+                default:
+                    writer.Key("type"sv).Value("Route"sv)
+                        .Key("from"sv).Value(string_view(StopName(random.Index(options.stops))))
+                        .Key("to"sv).Value(string_view(missing ? "Missing stop"s : StopName(random.Index(options.stops))));
+                    break;
+                }
+                writer.EndDict();
+            }
+            writer.EndArray();
+        }
+
+    }  // namespace
+
+    const std::vector<std::string> SEARCH_MODES = { "dijkstra"s, "bidirectional"s };
+
+    Context::Context(std::string description) {
+        GetContexts().push_back(move(description));
+    }
+
+    Context::~Context() {
+        GetContexts().pop_back();
+    }
+
+    void Fail(std::string_view message, const char* file, int line) {
+        ostringstream text;
+        text << file << ':' << line << ": check failed: " << message;
+        for (const string& context : GetContexts()) {
+            text << "\n    in " << context;
+        }
+        throw TestFailure(text.str());
+    }
+
+    int RunTests(const std::vector<std::pair<std::string_view, std::function<void()>>>& tests) {
+        size_t failed = 0;
+        for (const auto& [name, test] : tests) {
+            try {
+                test();
+                cerr << "[  OK  ] "sv << name << endl;
+            }
+            catch (const exception& e) {
+                ++failed;
+                cerr << "[FAILED] "sv << name << ": "sv << e.what() << endl;
+            }
+        }
+        cerr << tests.size() - failed << " of "sv << tests.size() << " tests passed"sv << endl;
+        return failed == 0 ? 0 : 1;
+    }
+
+    size_t GetAllocationCount() {
+        return allocation_count.load(memory_order_relaxed);
+    }
+
+    std::string MakeNetworkJson(const NetworkOptions& options) {
+        tools::Random random(options.seed);
+        const vector<Bus> buses = MakeBuses(options, random);
+        const auto distances = MakeDistances(buses, random);
+        // Координаты берутся всегда, чтобы запросы не зависели от with_base_requests
+        vector<pair<double, double>> coordinates;
+        for (size_t stop = 0; stop < options.stops; ++stop) {
+            const double lat = random.Uniform(55.57, 55.8);
+            coordinates.emplace_back(lat, random.Uniform(37.4, 37.7));
+        }
+
+        ostringstream output;
+        {
+            json::Writer writer(output);
+            writer.StartDict();
+            if (options.with_base_requests) {
+                WriteBaseRequests(writer, options, buses, distances, coordinates);
+            }
+            WriteSettings(writer, options);
+            if (options.with_stat_requests) {
+                WriteStatRequests(writer, options, random);
+            }
+            writer.EndDict();
+        }
+        return output.str();
+    }
+
+}  // namespace tests
+
+// Замена глобальных operator new/delete, которая только считает выделения.
+// Выровненные варианты остаются стандартными: они не смешиваются с этими
+void* operator new(size_t size) {
+    tests::allocation_count.fetch_add(1, memory_order_relaxed);
+    if (void* const ptr = malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
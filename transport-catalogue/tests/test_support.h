@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Проверки бросают tests::TestFailure с местом проверки и текущим контекстом;
+// RunTests ловит его и переходит к следующему тесту
+#define CHECK(condition) ::tests::Check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+#define CHECK_EQUAL(lhs, rhs) ::tests::CheckEqual((lhs), (rhs), #lhs " == " #rhs, __FILE__, __LINE__)
+#define CHECK_THROWS(expression, exception)                                      \
+    do {                                                                         \
+        bool thrown = false;                                                     \
+        try {                                                                    \
+            expression;                                                          \
+        }                                                                        \
+        catch (const exception&) {                                               \
+            thrown = true;                                                       \
+        }                                                                        \
+        ::tests::Check(thrown, #expression " throws " #exception, __FILE__, __LINE__); \
+    } while (false)
+
+namespace tests {
+
+    class TestFailure : public std::runtime_error {
+    public:
+        using runtime_error::runtime_error;
+    };
+
+    // Добавляет описание к сообщениям о провалах проверок, пока объект жив,
+    // например, какая пара остановок проверяется в цикле
+    class Context {
+    public:
+        explicit Context(std::string description);
+        Context(const Context&) = delete;
+        Context& operator=(const Context&) = delete;
+        ~Context();
+    };
+
+    [[noreturn]] void Fail(std::string_view message, const char* file, int line);
+
+    inline void Check(bool condition, std::string_view expression, const char* file, int line) {
+        if (!condition) {
+            Fail(expression, file, line);
+        }
+    }
+
+    template <typename T, typename = void>
+    struct IsPrintable : std::false_type {
+    };
+    template <typename T>
+    struct IsPrintable<T, std::void_t<decltype(std::declval<std::ostream&>() << std::declval<const T&>())>>
+        : std::true_type {
+    };
+
+    template <typename Lhs, typename Rhs>
+    void CheckEqual(const Lhs& lhs, const Rhs& rhs, std::string_view expression, const char* file, int line) {
+        if (lhs == rhs) {
+            return;
+        }
+        std::ostringstream message;
+        message.precision(17);
+        message << expression;
+        if constexpr (IsPrintable<Lhs>::value && IsPrintable<Rhs>::value) {
+            message << " (" << lhs << " != " << rhs << ")";
+        }
+        Fail(message.str(), file, line);
+    }
+
+    // Запускает тесты по порядку и печатает результат каждого; возвращает код выхода для ctest
+    int RunTests(const std::vector<std::pair<std::string_view, std::function<void()>>>& tests);
+
+    // Параметры случайной сети; одинаковый seed даёт одинаковый JSON на любой машине
+    struct NetworkOptions {
+        uint64_t seed = 1;
+        size_t stops = 40;
+        size_t buses = 10;
+        size_t queries = 200;
+        std::string search_mode = "dijkstra";
+        int thread_count = 1;
+        // Пустая строка — без serialization_settings
+        std::string serialization_file;
+        bool with_base_requests = true;
+        bool with_stat_requests = true;
+    };
+
+    /*
+     * Входной JSON: остановки со случайными расстояниями между соседями по маршрутам,
+     * автобусы (часть из них повторяет отрезки других, чтобы у маршрутов были
+     * равные по времени варианты), настройки и stat_requests всех типов,
+     * в том числе с неизвестными названиями
+     */
+    std::string MakeNetworkJson(const NetworkOptions& options);
+
+    // Число вызовов глобального operator new с начала программы: тесты сравнивают
+    // его до и после операции, чтобы проверить, сколько выделений памяти она делает
+    size_t GetAllocationCount();
+
+    // Режимы поиска в том виде, в каком они задаются в routing_settings
+    extern const std::vector<std::string> SEARCH_MODES;
+
+    inline std::string StopName(size_t stop) {
+        return "Stop " + std::to_string(stop);
+    }
+
+    // Возвращает всё, что func напечатала в stream
+    template <typename Func>
+    std::string CaptureOutput(std::ostream& stream, Func func) {
+        std::ostringstream output;
+        output.precision(stream.precision());
+        std::streambuf* const original = stream.rdbuf(output.rdbuf());
+        try {
+            func();
+        }
+        catch (...) {
+            stream.rdbuf(original);
+            throw;
+        }
+        stream.rdbuf(original);
+        return output.str();
+    }
+
+}  // namespace tests
@@ -0,0 +1,496 @@
+// Генератор синтетических транспортных сетей для нагрузочных тестов.
+// Пишет в stdout полный входной JSON: base_requests, render_settings, routing_settings
+// и stat_requests. При одинаковых параметрах вывод одинаков: числа берутся из mt19937_64
+// без стандартных распределений, результат которых зависит от реализации библиотеки.
+// Пример: network_generator --stops=100000 --buses=5000 --queries=10000 --seed=3 > network.json
+#include "json_writer.h"
+#include "random.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+    enum class RouteLength {
+        UNIFORM,
+        // Много коротких маршрутов и немного длинных, как в реальных сетях
+        EXPONENTIAL,
+    };
+
+    struct Options {
+        uint64_t seed = 1;
+        size_t stops = 1000;
+        size_t buses = 0;  // 0 — stops / 10
+        size_t min_route_stops = 5;
+        size_t max_route_stops = 30;
+        RouteLength route_length = RouteLength::UNIFORM;
+        double roundtrip_ratio = 0.4;
+        // Доля перегонов маршрутов, для которых задано дорожное расстояние
+        double segment_distances = 1.0;
+        // Среднее число дополнительных road_distances на остановку к случайным соседям
+        double extra_distances = 0.0;
+        size_t queries = 1000;
+        // Веса типов запросов Bus, Stop, Route и Map
+        double bus_weight = 4;
+        double stop_weight = 4;
+        double route_weight = 2;
+        double map_weight = 0;
+        // Доля запросов к несуществующим автобусам и остановкам
+        double missing_ratio = 0.05;
+        string search_mode = "dijkstra"s;
+        int bus_wait_time = 6;
+        double bus_velocity = 40;
+        int thread_count = -1;  // -1 — не писать execution_settings
+        string serialization_file;
+    };
+
+    void PrintUsage(ostream& output) {
+        output << "Usage: network_generator [--option=value]...\n"
+                  "  --seed=N                  random seed (1)\n"
+                  "  --stops=N                 stop count, 2..10000000 (1000)\n"
+                  "  --buses=N                 bus count (stops / 10)\n"
+                  "  --route-stops=MIN-MAX     stops per route before unrolling (5-30)\n"
+                  "  --route-length=KIND       uniform | exponential (uniform)\n"
+                  "  --roundtrip-ratio=P       share of roundtrip buses (0.4)\n"
+                  "  --segment-distances=P     share of route segments with road distances (1)\n"
+                  "  --extra-distances=D       extra road distances per stop (0)\n"
+                  "  --queries=N               stat request count (1000)\n"
+                  "  --mix=B,S,R,M             weights of Bus, Stop, Route and Map requests (4,4,2,0)\n"
+                  "  --missing-ratio=P         share of Bus/Stop requests for unknown names (0.05)\n"
+                  "  --search-mode=MODE        dijkstra | bidirectional\n"
+                  "  --bus-wait-time=N         minutes (6)\n"
+                  "  --bus-velocity=V          km/h (40)\n"
+                  "  --threads=N               write execution_settings.thread_count\n"
+                  "  --serialization-file=F    write serialization_settings.file\n";
+    }
+
+    template <typename Number>
+    Number ParseNumber(string_view name, string_view value) {
+        Number number{};
+        const auto [end, error] = from_chars(value.data(), value.data() + value.size(), number);
+        if (error != errc{} || end != value.data() + value.size()) {
+            throw invalid_argument("Invalid value for --"s + string(name) + ": "s + string(value));
+        }
+        return number;
+    }
+
+    double ParseRatio(string_view name, string_view value) {
+        const double ratio = ParseNumber<double>(name, value);
+        if (ratio < 0 || ratio > 1) {
+            throw invalid_argument("--"s + string(name) + " must be within [0, 1]"s);
+        }
+        return ratio;
+    }
+
+    Options ParseOptions(int argc, char* argv[]) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            const string_view arg(argv[i]);
+            const size_t eq = arg.find('=');
+            if (arg.substr(0, 2) != "--"sv || eq == string_view::npos) {
+                throw invalid_argument("Unexpected argument: "s + string(arg));
+            }
+            const string_view name = arg.substr(2, eq - 2);
+            const string_view value = arg.substr(eq + 1);
+            if (name == "seed"sv) {
+                options.seed = ParseNumber<uint64_t>(name, value);
+            }
+            else if (name == "stops"sv) {
+                options.stops = ParseNumber<size_t>(name, value);
+            }
+            else if (name == "buses"sv) {
+                options.buses = ParseNumber<size_t>(name, value);
+            }
+            else if (name == "route-stops"sv) {
+                const size_t dash = value.find('-');
+                if (dash == string_view::npos) {
+                    throw invalid_argument("--route-stops expects MIN-MAX"s);
+                }
+                options.min_route_stops = ParseNumber<size_t>(name, value.substr(0, dash));
+                options.max_route_stops = ParseNumber<size_t>(name, value.substr(dash + 1));
+            }
+            else if (name == "route-length"sv) {
+                if (value == "uniform"sv) {
+                    options.route_length = RouteLength::UNIFORM;
+                }
+                else if (value == "exponential"sv) {
+                    options.route_length = RouteLength::EXPONENTIAL;
+                }
+                else {
+                    throw invalid_argument("Unknown route length distribution: "s + string(value));
+                }
+            }
+            else if (name == "roundtrip-ratio"sv) {
+                options.roundtrip_ratio = ParseRatio(name, value);
+            }
+            else if (name == "segment-distances"sv) {
+                options.segment_distances = ParseRatio(name, value);
+            }
+            else if (name == "extra-distances"sv) {
+                options.extra_distances = ParseNumber<double>(name, value);
+            }
+            else if (name == "queries"sv) {
+                options.queries = ParseNumber<size_t>(name, value);
+            }
+            else if (name == "mix"sv) {
+                double* weights[] = { &options.bus_weight, &options.stop_weight, &options.route_weight, &options.map_weight };
+                string_view rest = value;
+                for (double* weight : weights) {
+                    const size_t comma = rest.find(',');
+                    *weight = ParseNumber<double>(name, rest.substr(0, comma));
+                    if (*weight < 0) {
+                        throw invalid_argument("--mix weights must be non-negative"s);
+                    }
+                    rest = comma == string_view::npos ? ""sv : rest.substr(comma + 1);
+                }
+            }
+            else if (name == "missing-ratio"sv) {
+                options.missing_ratio = ParseRatio(name, value);
+            }
+            else if (name == "search-mode"sv) {
+                if (value != "dijkstra"sv && value != "bidirectional"sv) {
+                    throw invalid_argument("Unknown search mode: "s + string(value));
+                }
+                options.search_mode = string(value);
+            }
+            else if (name == "bus-wait-time"sv) {
+                options.bus_wait_time = ParseNumber<int>(name, value);
+            }
+            else if (name == "bus-velocity"sv) {
+                options.bus_velocity = ParseNumber<double>(name, value);
+            }
+            else if (name == "threads"sv) {
+                options.thread_count = ParseNumber<int>(name, value);
+            }
+            else if (name == "serialization-file"sv) {
+                options.serialization_file = string(value);
+            }
+            else {
+                throw invalid_argument("Unknown option: --"s + string(name));
+            }
+        }
+        if (options.stops < 2 || options.stops > 10'000'000) {
+            throw invalid_argument("--stops must be within [2, 10000000]"s);
+        }
+        if (options.buses == 0) {
+            options.buses = max<size_t>(1, options.stops / 10);
+        }
+        if (options.min_route_stops < 2 || options.min_route_stops > options.max_route_stops) {
+            throw invalid_argument("--route-stops must satisfy 2 <= MIN <= MAX"s);
+        }
+        if (options.bus_weight + options.stop_weight + options.route_weight + options.map_weight <= 0) {
+            throw invalid_argument("--mix needs at least one positive weight"s);
+        }
+        return options;
+    }
+
+    using tools::Random;
+
+    // Остановки разбросаны по городу, а соседние остановки маршрута берутся
+    // из соседних клеток сетки, чтобы маршруты выглядели как линии, а не хаос
+    class Network {
+    public:
+        Network(const Options& options, Random& random)
+            : options_(options)
+            , random_(random)
+            , grid_size_(max<size_t>(1, static_cast<size_t>(sqrt(static_cast<double>(options.stops) / 8.0))))
+            , cells_(grid_size_ * grid_size_)
+            , distances_(options.stops) {
+            PlaceStops();
+            GenerateBuses();
+            GenerateExtraDistances();
+        }
+
+        struct Stop {
+            double latitude;
+            double longitude;
+            size_t cell;
+        };
+
+        struct Bus {
+            vector<uint32_t> stops;
+            bool is_roundtrip;
+        };
+
+        const vector<Stop>& GetStops() const {
+            return stops_;
+        }
+        const vector<Bus>& GetBuses() const {
+            return buses_;
+        }
+        const vector<pair<uint32_t, int>>& GetDistances(size_t stop) const {
+            return distances_[stop];
+        }
+
+    private:
+        static constexpr double MIN_LATITUDE = 55.5;
+        static constexpr double MAX_LATITUDE = 55.9;
+        static constexpr double MIN_LONGITUDE = 37.3;
+        static constexpr double MAX_LONGITUDE = 37.9;
+
+        void PlaceStops() {
+            stops_.reserve(options_.stops);
+            for (size_t i = 0; i < options_.stops; ++i) {
+                const double x = random_.Uniform();
+                const double y = random_.Uniform();
+                const size_t cell = min(grid_size_ - 1, static_cast<size_t>(y * grid_size_)) * grid_size_
+                    + min(grid_size_ - 1, static_cast<size_t>(x * grid_size_));
+                stops_.push_back({ MIN_LATITUDE + (MAX_LATITUDE - MIN_LATITUDE) * y,
+                                   MIN_LONGITUDE + (MAX_LONGITUDE - MIN_LONGITUDE) * x, cell });
+                cells_[cell].push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        size_t RouteStopCount() {
+            const size_t min_count = options_.min_route_stops;
+            const size_t max_count = options_.max_route_stops;
+            if (options_.route_length == RouteLength::UNIFORM) {
+                return min_count + random_.Index(max_count - min_count + 1);
+            }
+            // Среднее превышение над минимумом — четверть диапазона
+            const double mean = max(1.0, static_cast<double>(max_count - min_count) / 4.0);
+            const double extra = -mean * log(1.0 - random_.Uniform());
+            return min(max_count, min_count + static_cast<size_t>(extra));
+        }
+
+        // Случайная остановка в клетке соседней с клеткой stop (или в ней самой)
+        uint32_t NeighbourStop(uint32_t stop) {
+            const size_t cell = stops_[stop].cell;
+            const long row = static_cast<long>(cell / grid_size_);
+            const long column = static_cast<long>(cell % grid_size_);
+            for (int attempt = 0; attempt < 8; ++attempt) {
+                const long next_row = row + static_cast<long>(random_.Index(3)) - 1;
+                const long next_column = column + static_cast<long>(random_.Index(3)) - 1;
+                const long grid_size = static_cast<long>(grid_size_);
+                if (next_row < 0 || next_row >= grid_size || next_column < 0 || next_column >= grid_size) {
+                    continue;
+                }
+                const auto& candidates = cells_[static_cast<size_t>(next_row * grid_size + next_column)];
+                if (!candidates.empty()) {
+                    return candidates[random_.Index(candidates.size())];
+                }
+            }
+            return static_cast<uint32_t>(random_.Index(stops_.size()));
+        }
+
+        int RoadDistance(uint32_t from, uint32_t to) const {
+            // Дорога длиннее прямой на 20–60%, но не короче 100 м
+            const double dlat = (stops_[from].latitude - stops_[to].latitude) * 111'000.0;
+            const double dlng = (stops_[from].longitude - stops_[to].longitude) * 62'500.0;
+            return max(100, static_cast<int>(sqrt(dlat * dlat + dlng * dlng) * 1.4));
+        }
+
+        void AddDistance(uint32_t from, uint32_t to) {
+            if (from == to) {
+                return;
+            }
+            auto& stop_distances = distances_[from];
+            const auto it = find_if(stop_distances.begin(), stop_distances.end(),
+                [to](const pair<uint32_t, int>& distance) { return distance.first == to; });
+            if (it == stop_distances.end()) {
+                stop_distances.emplace_back(to, static_cast<int>(RoadDistance(from, to) * random_.Uniform(0.9, 1.15)));
+            }
+        }
+
+        void GenerateBuses() {
+            buses_.reserve(options_.buses);
+            for (size_t i = 0; i < options_.buses; ++i) {
+                Bus bus{ {}, random_.Chance(options_.roundtrip_ratio) };
+                const size_t stop_count = RouteStopCount();
+                bus.stops.push_back(static_cast<uint32_t>(random_.Index(stops_.size())));
+                while (bus.stops.size() < stop_count) {
+                    bus.stops.push_back(NeighbourStop(bus.stops.back()));
+                }
+                if (bus.is_roundtrip) {
+                    bus.stops.push_back(bus.stops.front());
+                }
+                for (size_t j = 1; j < bus.stops.size(); ++j) {
+                    if (random_.Chance(options_.segment_distances)) {
+                        AddDistance(bus.stops[j - 1], bus.stops[j]);
+                    }
+                }
+                buses_.push_back(move(bus));
+            }
+        }
+
+        void GenerateExtraDistances() {
+            if (options_.extra_distances <= 0) {
+                return;
+            }
+            // Пуассоновский поток с заданным средним на остановку через сумму экспонент
+            for (size_t stop = 0; stop < stops_.size(); ++stop) {
+                double time = -log(1.0 - random_.Uniform());
+                while (time < options_.extra_distances) {
+                    AddDistance(static_cast<uint32_t>(stop), NeighbourStop(static_cast<uint32_t>(stop)));
+                    time -= log(1.0 - random_.Uniform());
+                }
+            }
+        }
+
+        const Options& options_;
+        Random& random_;
+        const size_t grid_size_;
+        vector<vector<uint32_t>> cells_;
+        vector<Stop> stops_;
+        vector<Bus> buses_;
+        vector<vector<pair<uint32_t, int>>> distances_;
+    };
+
+    string StopName(size_t stop) {
+        return "Stop "s + to_string(stop);
+    }
+
+    string BusName(size_t bus) {
+        return "Bus "s + to_string(bus);
+    }
+
+    void WriteBaseRequests(json::Writer& writer, const Network& network) {
+        writer.Key("base_requests"sv).StartArray();
+        const auto& stops = network.GetStops();
+        for (size_t i = 0; i < stops.size(); ++i) {
+            writer.StartDict()
+                .Key("type"sv).Value("Stop"sv)
+                .Key("name"sv).Value(string_view(StopName(i)))
+                .Key("latitude"sv).Value(stops[i].latitude)
+                .Key("longitude"sv).Value(stops[i].longitude)
+                .Key("road_distances"sv).StartDict();
+            for (const auto& [to, distance] : network.GetDistances(i)) {
+                writer.Key(StopName(to)).Value(distance);
+            }
+            writer.EndDict().EndDict();
+        }
+        const auto& buses = network.GetBuses();
+        for (size_t i = 0; i < buses.size(); ++i) {
+            writer.StartDict()
+                .Key("type"sv).Value("Bus"sv)
+                .Key("name"sv).Value(string_view(BusName(i)))
+                .Key("is_roundtrip"sv).Value(buses[i].is_roundtrip)
+                .Key("stops"sv).StartArray();
+            for (uint32_t stop : buses[i].stops) {
+                writer.Value(string_view(StopName(stop)));
+            }
+            writer.EndArray().EndDict();
+        }
+        writer.EndArray();
+    }
+
+    void WriteSettings(json::Writer& writer, const Options& options) {
+        writer.Key("render_settings"sv).StartDict()
+            .Key("width"sv).Value(1200.0)
+            .Key("height"sv).Value(1200.0)
+            .Key("padding"sv).Value(50.0)
+            .Key("line_width"sv).Value(14.0)
+            .Key("stop_radius"sv).Value(5.0)
+            .Key("bus_label_font_size"sv).Value(20)
+            .Key("bus_label_offset"sv).StartArray().Value(7.0).Value(15.0).EndArray()
+            .Key("stop_label_font_size"sv).Value(20)
+            .Key("stop_label_offset"sv).StartArray().Value(7.0).Value(-3.0).EndArray()
+            .Key("underlayer_color"sv).StartArray().Value(255).Value(255).Value(255).Value(0.85).EndArray()
+            .Key("underlayer_width"sv).Value(3.0)
+            .Key("color_palette"sv).StartArray()
+                .Value("green"sv)
+                .StartArray().Value(255).Value(160).Value(0).EndArray()
+                .Value("red"sv)
+            .EndArray()
+            .EndDict();
+        writer.Key("routing_settings"sv).StartDict()
+            .Key("bus_wait_time"sv).Value(options.bus_wait_time)
+            .Key("bus_velocity"sv).Value(options.bus_velocity)
+            .Key("search_mode"sv).Value(string_view(options.search_mode))
+            .EndDict();
+        if (options.thread_count >= 0) {
+            writer.Key("execution_settings"sv).StartDict()
+                .Key("thread_count"sv).Value(options.thread_count)
+                .EndDict();
+        }
+        if (!options.serialization_file.empty()) {
+            writer.Key("serialization_settings"sv).StartDict()
+                .Key("file"sv).Value(string_view(options.serialization_file))
+                .EndDict();
+        }
+    }
+
+    void WriteStatRequests(json::Writer& writer, const Options& options, const Network& network, Random& random) {
+        const double weights[] = { options.bus_weight, options.stop_weight, options.route_weight, options.map_weight };
+        const double total_weight = weights[0] + weights[1] + weights[2] + weights[3];
+        const size_t stop_count = network.GetStops().size();
+        const size_t bus_count = network.GetBuses().size();
+
+        writer.Key("stat_requests"sv).StartArray();
+        for (size_t id = 1; id <= options.queries; ++id) {
+            double pick = random.Uniform() * total_weight;
+            size_t type = 0;
+            while (type + 1 < size(weights) && (weights[type] == 0 || pick >= weights[type])) {
+                pick -= weights[type];
+                ++type;
+            }
+            writer.StartDict().Key("id"sv).Value(static_cast<int>(id));
+            const bool missing = random.Chance(options.missing_ratio);
+            switch (type) {
+            case 0:
+                writer.Key("type"sv).Value("Bus"sv)
+                    .Key("name"sv).Value(string_view(missing ? "Missing bus "s + to_string(id) : BusName(random.Index(bus_count))));
+                break;
+            case 1:
+                writer.Key("type"sv).Value("Stop"sv)
+                    .Key("name"sv).Value(string_view(missing ? "Missing stop "s + to_string(id) : StopName(random.Index(stop_count))));
+                break;
+            case 2: {
+                const size_t from = random.Index(stop_count);
+                writer.Key("type"sv).Value("Route"sv)
+                    .Key("from"sv).Value(string_view(StopName(from)))
+                    .Key("to"sv).Value(string_view(StopName(random.Index(stop_count))));
+                break;
+            }
+            default:
+                writer.Key("type"sv).Value("Map"sv);
+                break;
+            }
+            writer.EndDict();
+        }
+        writer.EndArray();
+    }
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc == 2 && argv[1] == "--help"sv) {
+        PrintUsage(cout);
+        return 0;
+    }
+    Options options;
+    try {
+        options = ParseOptions(argc, argv);
+    }
+    catch (const exception& e) {
+        cerr << e.what() << endl;
+        PrintUsage(cerr);
+        return 1;
+    }
+
+    ios::sync_with_stdio(false);
+    // Координаты с точностью до сантиметров
+    cout.precision(10);
+    Random random(options.seed);
+    const Network network(options, random);
+    {
+        json::Writer writer(cout);
+        writer.StartDict();
+        WriteBaseRequests(writer, network);
+        WriteSettings(writer, options);
+        WriteStatRequests(writer, options, network, random);
+        writer.EndDict();
+    }
+    cout << '\n';
+    return cout ? 0 : 1;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+namespace tools {
+
+    // Случайные числа прямо из mt19937_64, без стандартных распределений:
+    // их результат зависит от реализации библиотеки, а сгенерированные сети
+    // и бенчмарки должны совпадать на любой машине при одинаковом seed
+    class Random {
+    public:
+        explicit Random(uint64_t seed)
+            : engine_(seed) {
+        }
+
+        // Равномерно в [0, 1)
+        double Uniform() {
+            return static_cast<double>(engine_() >> 11) * 0x1.0p-53;
+        }
+        double Uniform(double from, double to) {
+            return from + (to - from) * Uniform();
+        }
+        // Равномерно в [0, count); смещение от взятия остатка при count << 2^64 пренебрежимо
+        size_t Index(size_t count) {
+            return static_cast<size_t>(engine_() % count);
+        }
+        bool Chance(double probability) {
+            return Uniform() < probability;
+        }
+
+    private:
+        std::mt19937_64 engine_;
+    };
+
+}  // namespace tools
@@ -0,0 +1,143 @@
+#include "trace.h"
+#include "json_writer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace std;
+
+namespace trace {
+
+    namespace {
+        struct Event {
+            const char* name;
+            int thread_id;
+            uint64_t start_us;
+            uint64_t duration_us;
+            int64_t heap_delta;
+        };
+
+        atomic<bool> enabled{ false };
+        mutex events_mutex;
+        vector<Event> events;
+        const chrono::steady_clock::time_point origin = chrono::steady_clock::now();
+        atomic<int> next_thread_id{ 1 };
+        atomic<bool> heap_accounting{ false };
+        // Байты кучи, выделенные минус освобождённые текущим потоком
+        thread_local int64_t thread_heap_bytes = 0;
+
+        uint64_t NowMicroseconds() {
+            return static_cast<uint64_t>(chrono::duration_cast<chrono::microseconds>(
+                chrono::steady_clock::now() - origin).count());
+        }
+
+        // Небольшие номера потоков в порядке первого спана: поток сессии получает 1
+        int GetThreadId() {
+            thread_local const int thread_id = next_thread_id.fetch_add(1);
+            return thread_id;
+        }
+
+
+        void WriteEvents(ostream& output, const vector<Event>& trace_events, int thread_count, bool with_heap) {
+            // Время в микросекундах пишется целыми числами
+            output.precision(17);
+            const double pid = static_cast<double>(getpid());
+            json::Writer writer(output);
+            writer.StartDict().Key("traceEvents"sv).StartArray();
+            for (int thread_id = 1; thread_id < thread_count; ++thread_id) {
+                writer.StartDict()
+                    .Key("name"sv).Value("thread_name"sv)
+                    .Key("ph"sv).Value("M"sv)
+                    .Key("pid"sv).Value(pid)
+                    .Key("tid"sv).Value(thread_id)
+                    .Key("args"sv).StartDict()
+                    .Key("name"sv).Value(string_view(thread_id == 1 ? "main"s : "worker "s + to_string(thread_id - 1)))
+                    .EndDict()
+                    .EndDict();
+            }
+            for (const Event& event : trace_events) {
+                writer.StartDict()
+                    .Key("name"sv).Value(event.name)
+                    .Key("cat"sv).Value("phase"sv)
+                    .Key("ph"sv).Value("X"sv)
+                    .Key("ts"sv).Value(static_cast<double>(event.start_us))
+                    .Key("dur"sv).Value(static_cast<double>(event.duration_us))
+                    .Key("pid"sv).Value(pid)
+                    .Key("tid"sv).Value(event.thread_id);
+                if (with_heap) {
+                    writer.Key("args"sv).StartDict()
+                        .Key("heap_delta_bytes"sv).Value(static_cast<double>(event.heap_delta))
+                        .EndDict();
+                }
+                writer.EndDict();
+            }
+            writer.EndArray()
+                .Key("displayTimeUnit"sv).Value("ms"sv)
+                .EndDict();
+        }
+    }
+
+    namespace detail {
+        void EnableHeapAccounting() noexcept {
+            heap_accounting = true;
+        }
+
+        void AddHeapBytes(int64_t delta) noexcept {
+            thread_heap_bytes += delta;
+        }
+    }
+
+    string GetOutputPath() {
+        const char* path = getenv("TRANSPORT_TRACE_FILE");
+        return path && *path ? string(path) : "transport_trace.json"s;
+    }
+
+    Session::Session(string path)
+        : path_(move(path)) {
+        GetThreadId();
+        enabled = true;
+    }
+
+    Session::~Session() {
+        enabled = false;
+        vector<Event> trace_events;
+        {
+            lock_guard guard(events_mutex);
+            trace_events.swap(events);
+        }
+        ofstream output(path_);
+        WriteEvents(output, trace_events, next_thread_id.load(), heap_accounting.load());
+        output << '\n';
+        if (!output) {
+            // Деструктор не бросает: трасса — диагностика и не должна ронять программу
+            cerr << "Can't write trace to "sv << path_ << endl;
+        }
+    }
+
+    Span::Span(const char* name)
+        : name_(name)
+        , active_(enabled.load(memory_order_relaxed)) {
+        if (active_) {
+            start_heap_ = thread_heap_bytes;
+            start_us_ = NowMicroseconds();
+        }
+    }
+
+    Span::~Span() {
+        if (!active_) {
+            return;
+        }
+        const uint64_t end_us = NowMicroseconds();
+        const Event event{ name_, GetThreadId(), start_us_, end_us - start_us_, thread_heap_bytes - start_heap_ };
+        lock_guard guard(events_mutex);
+        events.push_back(event);
+    }
+
+}  // namespace trace
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/*
+ * Трассировка фаз в формате Chrome trace events (открывается в chrome://tracing
+ * и ui.perfetto.dev). Спаны вкомпилированы, только если определён TRANSPORT_TRACE
+ * (опция CMake TRANSPORT_CATALOGUE_TRACE); иначе макросы раскрываются в пустоту.
+ *
+ * TRACE_SESSION() в main включает запись, а при выходе из области видимости пишет трассу
+ * в файл из переменной окружения TRANSPORT_TRACE_FILE (по умолчанию transport_trace.json).
+ * TRACE_SCOPE("имя") отмечает время от объявления до конца блока и номер потока.
+ * Если к программе подключён trace_alloc.cpp (приложение, собранное с трассировкой),
+ * спан ещё пишет heap_delta_bytes — сколько байт кучи выделил минус освободил
+ * за это время его собственный поток, так что параллельные спаны не смешиваются
+ */
+#ifdef TRANSPORT_TRACE
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SESSION() const ::trace::Session TRACE_CONCAT(trace_session_, __LINE__)(::trace::GetOutputPath())
+#define TRACE_SCOPE(name) const ::trace::Span TRACE_CONCAT(trace_span_, __LINE__)(name)
+#else
+#define TRACE_SESSION() static_cast<void>(0)
+#define TRACE_SCOPE(name) static_cast<void>(0)
+#endif
+
+namespace trace {
+
+    // Путь к файлу трассы из TRANSPORT_TRACE_FILE или transport_trace.json
+    std::string GetOutputPath();
+
+    namespace detail {
+        // Учёт кучи по потокам; вызывается из operator new/delete в trace_alloc.cpp
+        void EnableHeapAccounting() noexcept;
+        void AddHeapBytes(int64_t delta) noexcept;
+    }
+
+    // Пока сессия жива, спаны записываются; деструктор пишет их в файл
+    class Session {
+    public:
+        explicit Session(std::string path);
+        Session(const Session&) = delete;
+        Session& operator=(const Session&) = delete;
+        ~Session();
+
+    private:
+        std::string path_;
+    };
+
+    // name должен жить до конца сессии: обычно это строковый литерал
+    class Span {
+    public:
+        explicit Span(const char* name);
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+        ~Span();
+
+    private:
+        const char* name_;
+        bool active_;
+        uint64_t start_us_ = 0;
+        int64_t start_heap_ = 0;
+    };
+
+}  // namespace trace
@@ -0,0 +1,54 @@
+// Замена глобальных operator new/delete для трассировки: каждый поток считает байты кучи,
+// которые он выделил и освободил, и спан видит изменение кучи только своего потока.
+// Подключается только к приложению: у бенчмарков своя замена operator new со счётчиком выделений
+#ifdef TRANSPORT_TRACE
+
+#include "trace.h"
+
+#include <cstdlib>
+#include <new>
+
+#include <malloc.h>
+
+namespace {
+    // Размер блока берётся у malloc и при выделении, и при освобождении, поэтому суммы сходятся
+    int64_t BlockSize(void* ptr) {
+        return static_cast<int64_t>(malloc_usable_size(ptr));
+    }
+
+    [[maybe_unused]] const bool heap_accounting = (trace::detail::EnableHeapAccounting(), true);
+}
+
+void* operator new(size_t size) {
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    trace::detail::AddHeapBytes(BlockSize(ptr));
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr) {
+        trace::detail::AddHeapBytes(-BlockSize(ptr));
+        std::free(ptr);
+    }
+}
+
+void operator delete[](void* ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+#endif
@@ -7,20 +7,96 @@ using namespace transport::core;
 using namespace std;
 
 void TransportCatalogue::AddRoute(const string& name, const vector<string_view>& stops, const std::string& last_stop) {
-    routes_.emplace_back(move(Route{ name, {stops.begin(),stops.end()}, last_stop}));
+    vector<uint32_t> stop_indices;
+    stop_indices.reserve(stops.size());
+    for (string_view stop : stops) {
+        stop_indices.push_back(static_cast<uint32_t>(FindStop(stop)->idx));
+    }
+    AddRoute(name, move(stop_indices), static_cast<uint32_t>(FindStop(last_stop)->idx));
+}
+
+void TransportCatalogue::AddRoute(const string& name, vector<uint32_t> stops, uint32_t last_stop) {
+    Route route{ name, move(stops), last_stop, routes_.size() };
+    ++version_;
+    routes_.emplace_back(move(route));
     names_of_routes_[routes_.back().name] = &routes_.back();
-    for (auto& it : names_of_routes_[routes_.back().name]->stops) {
-        routes_of_stops_[it].emplace(routes_.back().name);
+    constRoutePtr added_route = &routes_.back();
+    for (uint32_t stop_idx : added_route->stops) {
+        auto& stop_routes = routes_of_stops_[stop_idx];
+        if (!finalized_) {
+            // Повторы (кольцевой маршрут, обратный ход) убирает Finalize
+            if (stop_routes.empty() || stop_routes.back() != added_route) {
+                stop_routes.push_back(added_route);
+            }
+            continue;
+        }
+        auto it = lower_bound(stop_routes.begin(), stop_routes.end(), added_route,
+            [](constRoutePtr lhs, constRoutePtr rhs) {return lhs->name < rhs->name; });
+        if (it == stop_routes.end() || *it != added_route) {
+            stop_routes.insert(it, added_route);
+        }
+    }
+    if (finalized_) {
+        route_stats_.push_back(ComputeRouteStat(added_route));
+    }
+}
+
+void TransportCatalogue::Finalize() {
+    SortRoutesOfStops();
+    route_stats_.clear();
+    route_stats_.reserve(routes_.size());
+    for (const Route& route : routes_) {
+        route_stats_.push_back(ComputeRouteStat(&route));
+    }
+    finalized_ = true;
+}
+
+void TransportCatalogue::Finalize(vector<RouteStat> route_stats) {
+    if (route_stats.size() != routes_.size()) {
+        throw invalid_argument("Route stats don't match the routes");
+    }
+    SortRoutesOfStops();
+    route_stats_ = move(route_stats);
+    finalized_ = true;
+}
+
+void TransportCatalogue::SortRoutesOfStops() {
+    for (auto& stop_routes : routes_of_stops_) {
+        sort(stop_routes.begin(), stop_routes.end(), [](constRoutePtr lhs, constRoutePtr rhs) {return lhs->name < rhs->name; });
+        stop_routes.erase(unique(stop_routes.begin(), stop_routes.end()), stop_routes.end());
+    }
+}
+
+void TransportCatalogue::CheckFinalized() const {
+    if (!finalized_) {
+        throw logic_error("TransportCatalogue::Finalize must be called after loading");
     }
 }
 
 void TransportCatalogue::AddStop(const string& name, const geo::Coordinates& coordinates) {
+    ++version_;
     stops_.emplace_back(move(Stop{ name, coordinates, stops_.size()}));
     names_of_stops_[stops_.back().name] = &stops_.back();
-    routes_of_stops_[stops_.back().name];
+    routes_of_stops_.emplace_back();
+    distances_.emplace_back();
 }
 void TransportCatalogue::AddDistance(constStopPtr first, constStopPtr second, const int& distance) {
-    distances_[{first, second}] = distance;
+    ++version_;
+    auto& stop_distances = distances_[first->idx];
+    auto it = lower_bound(stop_distances.begin(), stop_distances.end(), second->idx,
+        [](const StopDistance& stop_distance, size_t idx) {return stop_distance.to_idx < idx; });
+    if (it != stop_distances.end() && it->to_idx == second->idx) {
+        it->distance = distance;
+    }
+    else {
+        stop_distances.insert(it, { second->idx, distance });
+    }
+    if (finalized_) {
+        // Любой маршрут, проходящий по участку first-second в любую сторону, проходит через first
+        for (constRoutePtr route : routes_of_stops_[first->idx]) {
+            route_stats_[route->idx] = ComputeRouteStat(route);
+        }
+    }
 }
 
 TransportCatalogue::constRoutePtr TransportCatalogue::FindRoute(const string_view name) const {
@@ -31,32 +107,60 @@ TransportCatalogue::constStopPtr TransportCatalogue::FindStop(const string_view
     return names_of_stops_.count(name) ? names_of_stops_.at(name) : nullptr;
 }
 
-int TransportCatalogue::FindDistance(const string_view first, const string_view second) const {
-    pairConstStopPtr p(FindStop(first), FindStop(second));
-    if (distances_.count(p)) {
-        return distances_.at(p);
+const Stop& TransportCatalogue::GetStop(size_t idx) const {
+    return stops_[idx];
+}
+
+int TransportCatalogue::FindDistance(constStopPtr first, constStopPtr second) const {
+    return FindDistance(first->idx, second->idx);
+}
+
+int TransportCatalogue::FindDistance(size_t first_idx, size_t second_idx) const {
+    auto find = [this](size_t from_idx, size_t to_idx) -> const StopDistance* {
+        const auto& stop_distances = distances_[from_idx];
+        auto it = lower_bound(stop_distances.begin(), stop_distances.end(), to_idx,
+            [](const StopDistance& stop_distance, size_t idx) {return stop_distance.to_idx < idx; });
+        return it != stop_distances.end() && it->to_idx == to_idx ? &*it : nullptr;
+    };
+    if (const StopDistance* direct = find(first_idx, second_idx)) {
+        return direct->distance;
     }
-    pairConstStopPtr sp(FindStop(second), FindStop(first));
-    if (distances_.count(sp)) {
-        return distances_.at(sp);
+    if (const StopDistance* reverse = find(second_idx, first_idx)) {
+        return reverse->distance;
     }
     return 0;
 }
 
 const TransportCatalogue::RouteStat TransportCatalogue::GetRoute(const std::string_view name) const {
-    constRoutePtr route = FindRoute(name);
+    CheckFinalized();
+    return route_stats_[FindRoute(name)->idx];
+}
+
+TransportCatalogue::RouteStat TransportCatalogue::ComputeRouteStat(constRoutePtr route) const {
+    // У маршрута без участков длины нулевые, а кривизна не определена
+    if (route->stops.size() < 2) {
+        return { route->stops.size(), route->stops.size(), 0, 0.0 };
+    }
     int route_distance = ComputeRouteDistance(route);
-    return { route->stops.size(), unordered_set<string_view>(route->stops.begin(), route->stops.end()).size() ,route_distance,  route_distance/ComputeRouteLength(route)};
+    return { route->stops.size(), unordered_set<uint32_t>(route->stops.begin(), route->stops.end()).size() ,route_distance,  route_distance/ComputeRouteLength(route)};
 }
 
-const set<string_view> TransportCatalogue::GetRoutesOfStop(const std::string_view name_of_stop) const {
-    return routes_of_stops_.at(name_of_stop);
+TransportCatalogue::RoutesOfStopRange TransportCatalogue::GetRoutesOfStop(const std::string_view name_of_stop) const {
+    CheckFinalized();
+    return ranges::AsRange(routes_of_stops_[FindStop(name_of_stop)->idx]);
 }
 
 double TransportCatalogue::ComputeRouteLength(constRoutePtr route) const {
+    vector<geo::PreparedCoordinates> points;
+    points.reserve(route->stops.size());
+    for (uint32_t stop_idx : route->stops) {
+        points.push_back(stops_[stop_idx].prepared);
+    }
+    vector<double> distances(points.size() - 1);
+    geo::ComputeDistances(points.data(), points.size(), distances.data());
     double route_length = 0;
-    for (auto it = route->stops.begin(); it != route->stops.end()-1; it++) {
-        route_length += ComputeDistance(FindStop(*it)->coordinates, FindStop(*next(it))->coordinates);
+    for (double distance : distances) {
+        route_length += distance;
     }
     return route_length;
 }
@@ -85,6 +189,19 @@ const std::deque<Route>& TransportCatalogue::GetAllBuses() const {
     return routes_;
 }
 
+const std::vector<TransportCatalogue::RouteStat>& TransportCatalogue::GetRouteStats() const {
+    CheckFinalized();
+    return route_stats_;
+}
+
+const std::deque<Stop>& TransportCatalogue::GetAllStops() const {
+    return stops_;
+}
+
 size_t TransportCatalogue::GetStopsCount() const {
     return  stops_.size();
-}
\ No newline at end of file
+}
+
+uint64_t TransportCatalogue::GetVersion() const {
+    return version_;
+}
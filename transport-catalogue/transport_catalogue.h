@@ -1,11 +1,13 @@
 #pragma once
 
+#include <cstdint>
 #include <deque>
 #include <unordered_map>
-#include <set>
+#include <vector>
 
 #include "domain.h"
 #include "geo.h"
+#include "ranges.h"
 
 namespace transport::core {
     
@@ -21,39 +23,78 @@ namespace transport::core {
 
         using constRoutePtr = const Route*;
         using constStopPtr = const Stop*;
+        using RoutesOfStopRange = ranges::Range<std::vector<constRoutePtr>::const_iterator>;
  
         void AddRoute(const std::string& name, const std::vector<std::string_view>& stops, const std::string& last_stop);
+        // Добавляет маршрут по индексам остановок (Stop::idx), без поиска по именам
+        void AddRoute(const std::string& name, std::vector<uint32_t> stops, uint32_t last_stop);
         void AddStop(const std::string& name, const geo::Coordinates& coordinates);
         void AddDistance(constStopPtr first, constStopPtr second, const int& distance);
+        // Завершает загрузку: строит индексы, которые дорого поддерживать при каждой вставке,
+        // и считает статистику всех маршрутов. Вызывается после того, как добавлены все
+        // остановки, расстояния и маршруты, и перед запросами к GetRoute и GetRoutesOfStop.
+        // Изменения после Finalize сразу обновляют индексы и статистику затронутых маршрутов
+        void Finalize();
+        // То же, но со статистикой маршрутов, посчитанной заранее (по Route::idx), например
+        // прочитанной из снимка: пересчёт длин по всем маршрутам не нужен
+        void Finalize(std::vector<RouteStat> route_stats);
 
         std::deque<Route> GetSortedRoutes() const;
         std::deque<Stop> GetSortedStops() const;
         
         constRoutePtr FindRoute(const std::string_view name) const;
         constStopPtr FindStop(const std::string_view name) const;
-        int FindDistance(const std::string_view first, const std::string_view second) const;
+        const Stop& GetStop(size_t idx) const;
+        int FindDistance(constStopPtr first, constStopPtr second) const;
+        int FindDistance(size_t first_idx, size_t second_idx) const;
 
         const RouteStat GetRoute(const std::string_view name) const;
-        const std::set<std::string_view> GetRoutesOfStop(const std::string_view name_of_stop) const;
+        // Маршруты, проходящие через остановку, отсортированные по имени. Не копирует данные
+        RoutesOfStopRange GetRoutesOfStop(const std::string_view name_of_stop) const;
         const std::deque<Route>& GetAllBuses() const;
+        // Статистика всех маршрутов по Route::idx
+        const std::vector<RouteStat>& GetRouteStats() const;
+        const std::deque<Stop>& GetAllStops() const;
         size_t GetStopsCount() const;
-    private:
-        using pairConstStopPtr = std::pair<constStopPtr, constStopPtr>;
-
-        struct Hasher {
-            std::size_t operator()(const pairConstStopPtr& pair) const {
-                return std::hash<constStopPtr>{}(pair.first) * 37 + std::hash<constStopPtr>{}(pair.second);
+        // Вызывает callback(to_idx, distance) для всех заданных расстояний от остановки
+        // в порядке возрастания to_idx
+        template <typename Callback>
+        void ForEachDistance(size_t from_idx, Callback&& callback) const {
+            for (const StopDistance& stop_distance : distances_[from_idx]) {
+                callback(stop_distance.to_idx, stop_distance.distance);
             }
+        }
+        // Номер состояния каталога: увеличивается при каждом изменении,
+        // по нему кэши производных данных понимают, что устарели
+        uint64_t GetVersion() const;
+    private:
+        struct StopDistance {
+            size_t to_idx;
+            int distance;
         };
 
         std::deque<Route> routes_;
         std::deque<Stop> stops_;
-        std::unordered_map<pairConstStopPtr, int, Hasher> distances_;
+        uint64_t version_ = 0;
+        bool finalized_ = false;
+        // Статистика маршрутов (по Route::idx), считается в Finalize, а после него —
+        // пересчитывается для маршрутов, которые затрагивает AddRoute или AddDistance.
+        // Запросы только читают её, поэтому потоки берут её без блокировок
+        std::vector<RouteStat> route_stats_;
+        // Для каждой остановки (по Stop::idx) — отсортированный по to_idx список расстояний
+        std::vector<std::vector<StopDistance>> distances_;
 
         std::unordered_map<std::string_view, constRoutePtr> names_of_routes_;
         std::unordered_map<std::string_view, constStopPtr> names_of_stops_;
-        std::unordered_map<std::string_view, std::set<std::string_view>> routes_of_stops_;
+        // Для каждой остановки (по Stop::idx) — маршруты через неё. До Finalize маршруты
+        // дописываются в конец, Finalize сортирует их по имени и убирает повторы,
+        // а после него новые маршруты вставляются сразу на своё место
+        std::vector<std::vector<constRoutePtr>> routes_of_stops_;
+
+        void CheckFinalized() const;
+        void SortRoutesOfStops();
 
+        RouteStat ComputeRouteStat(constRoutePtr route) const;
         double ComputeRouteLength(constRoutePtr route) const;
         int ComputeRouteDistance(constRoutePtr route) const;
     };
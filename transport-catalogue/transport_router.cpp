@@ -1,34 +1,110 @@
 #include "transport_router.h"
+#include "parallel.h"
+#include "trace.h"
 
-std::optional<OptimalRoute> Transport_router::GetOptimalRoute(std::string_view from, std::string_view to) const {
+#include <cmath>
+#include <stdexcept>
+
+// Число рёбер у автобусов сильно различается, поэтому блоки небольшие
+const size_t BUS_CHUNK_SIZE = 8;
+
+RouteWeight RouteWeight::FromMinutes(double minutes, uint64_t edge_id) {
+    // Финальное перемешивание splitmix64
+    uint64_t hash = edge_id + 0x9e3779b97f4a7c15ULL;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+    return { static_cast<uint64_t>(std::llround(minutes * TICKS_PER_MINUTE)), (uint64_t{ 1 } << 40) + (hash >> 32) };
+}
 
-    std::optional<graph::Router<double>::RouteInfo> route_info
-        = router_.BuildRoute(catalogue_.FindStop(from)->idx
-                            ,catalogue_.FindStop(to)->idx);
+std::optional<OptimalRoute> Transport_router::GetOptimalRoute(std::string_view from, std::string_view to) const {
+    const auto from_stop = catalogue_.FindStop(from);
+    const auto to_stop = catalogue_.FindStop(to);
+    // Неизвестная остановка — такой же ответ "not found", как и отсутствие пути
+    if (!from_stop || !to_stop) {
+        return std::nullopt;
+    }
+    std::optional<graph::Router<RouteWeight>::RouteInfo> route_info = router_.BuildRoute(from_stop->idx, to_stop->idx);
     if (route_info == std::nullopt) {
         return std::nullopt;
     }
+    // Тики веса нужны только для сравнения путей, а время — сумма участков в минутах по порядку пути
     OptimalRoute optimalRoute;
     for (const auto& edgeID : route_info.value().edges) {
-        optimalRoute.items.push_back(id_of_Item_.at(edgeID));
+        const RouteItem& item = items_[edgeID];
+        optimalRoute.items.push_back(item);
+        optimalRoute.total_time += item.time + routing_settings_.bus_wait_time;
     }
-    optimalRoute.total_time = route_info.value().weight;
     return optimalRoute;
 }
 
-const Transport_router::Graph Transport_router::InitGraph() {
-    Graph graph(catalogue_.GetStopsCount());
-    for (const Route& bus : catalogue_.GetAllBuses()) {
-        for (auto from_it = bus.stops.begin(); from_it!= bus.stops.end(); ++from_it) {
-            double time = 0;
-            int span_count = 0;
-            const Stop* stop = catalogue_.FindStop(*from_it);
-            for (auto to_it = std::next(from_it); to_it != bus.stops.end(); ++to_it) {
-                time += (double(catalogue_.FindDistance(*std::prev(to_it), *to_it)) / routing_settings_.bus_velocity);
-                graph::EdgeId id = graph.AddEdge({ stop->idx, catalogue_.FindStop(*to_it)->idx, time + routing_settings_.bus_wait_time });
-                id_of_Item_.emplace(id, RouteItem{ stop , &bus , time , ++span_count });
+std::vector<size_t> Transport_router::InitEdgeOffsets() const {
+    const auto& buses = catalogue_.GetAllBuses();
+    std::vector<size_t> edge_offsets(buses.size() + 1, 0);
+    for (size_t i = 0; i < buses.size(); ++i) {
+        const size_t stop_count = buses[i].stops.size();
+        edge_offsets[i + 1] = edge_offsets[i] + stop_count * (stop_count - 1) / 2;
+    }
+    return edge_offsets;
+}
+
+double Transport_router::GetSegmentTime(const Route& bus, size_t stop) const {
+    return double(catalogue_.FindDistance(bus.stops[stop - 1], bus.stops[stop])) / routing_settings_.bus_velocity;
+}
+
+const Transport_router::Graph Transport_router::InitGraph(size_t thread_count) {
+    TRACE_SCOPE("Transport_router::InitGraph");
+    const auto& buses = catalogue_.GetAllBuses();
+    // Рёбра каждого автобуса занимают заранее известный отрезок, поэтому потоки
+    // пишут их на свои места без слияния, а id рёбер не зависят от числа потоков
+    std::vector<graph::Edge<RouteWeight>> edges(edge_offsets_.back());
+    items_.resize(edge_offsets_.back());
+
+    parallel::ForEachChunk(buses.size(), BUS_CHUNK_SIZE, parallel::ResolveThreadCount(thread_count),
+        [&](size_t begin, size_t end) {
+            std::vector<double> segment_times;
+            for (size_t i = begin; i < end; ++i) {
+                const Route& bus = buses[i];
+                // Время каждого перегона считается один раз, а не для каждой начальной остановки
+                segment_times.clear();
+                for (size_t stop = 1; stop < bus.stops.size(); ++stop) {
+                    segment_times.push_back(GetSegmentTime(bus, stop));
+                }
+                size_t edge_id = edge_offsets_[i];
+                for (size_t from = 0; from < bus.stops.size(); ++from) {
+                    double time = 0;
+                    int span_count = 0;
+                    const Stop* stop = &catalogue_.GetStop(bus.stops[from]);
+                    for (size_t to = from + 1; to < bus.stops.size(); ++to) {
+                        time += segment_times[to - 1];
+                        edges[edge_id] = { stop->idx, bus.stops[to],
+                                           RouteWeight::FromMinutes(time + routing_settings_.bus_wait_time, edge_id) };
+                        items_[edge_id] = RouteItem{ stop, &bus, time, ++span_count };
+                        ++edge_id;
+                    }
+                }
             }
-        }
+        });
+    return Graph(catalogue_.GetStopsCount(), std::move(edges));
+}
+
+Transport_router::Graph Transport_router::CheckGraph(Graph graph) const {
+    // items_ и участки автобусов в InitEdgeOffsets адресуются теми же id рёбер
+    if (graph.GetVertexCount() != catalogue_.GetStopsCount() || graph.GetEdgeCount() != edge_offsets_.back()
+        || items_.size() != edge_offsets_.back()) {
+        throw std::invalid_argument("Router graph doesn't match the catalogue");
     }
     return graph;
-}
\ No newline at end of file
+}
+
+const Transport_router::Graph& Transport_router::GetGraph() const {
+    return graph_;
+}
+
+const std::vector<RouteItem>& Transport_router::GetItems() const {
+    return items_;
+}
+
+const graph::Router<RouteWeight>& Transport_router::GetRouter() const {
+    return router_;
+}
@@ -3,9 +3,12 @@
 #include "router.h"
 #include "transport_catalogue.h"
 
+#include <cstdint>
+
 struct RoutingSettings {
     int bus_wait_time;
     double bus_velocity;
+    graph::SearchMode search_mode = graph::SearchMode::DIJKSTRA;
 };
 struct RouteItem {
     const Stop* stop;
@@ -13,6 +16,37 @@ struct RouteItem {
     double time = 0.0;
     int span_count = 0;
 };
+/*
+ * Вес ребра графа маршрутизатора: время в целых тиках и ключ, разрешающий равенство времени.
+ * Целые числа складываются точно, поэтому вес пути не зависит от порядка сложения,
+ * а ключ у разных путей почти наверняка различен. Кратчайший путь получается единственным,
+ * и любой режим поиска находит те же рёбра, что и Дейкстра
+ */
+struct RouteWeight {
+    // Тиков в минуте: округление до них не различает пути, чьё время совпадает до погрешности double
+    static constexpr double TICKS_PER_MINUTE = 1e6;
+
+    uint64_t ticks = 0;
+    uint64_t tie = 0;
+
+    // Ключ ребра — 2^40 плюс 32-битный хэш его id: при равном времени выигрывает путь
+    // с меньшим числом поездок, а среди них — с меньшей суммой хэшей
+    static RouteWeight FromMinutes(double minutes, uint64_t edge_id);
+};
+
+inline RouteWeight operator+(RouteWeight lhs, RouteWeight rhs) {
+    return { lhs.ticks + rhs.ticks, lhs.tie + rhs.tie };
+}
+inline bool operator<(RouteWeight lhs, RouteWeight rhs) {
+    return lhs.ticks < rhs.ticks || (lhs.ticks == rhs.ticks && lhs.tie < rhs.tie);
+}
+inline bool operator>(RouteWeight lhs, RouteWeight rhs) {
+    return rhs < lhs;
+}
+inline bool operator==(RouteWeight lhs, RouteWeight rhs) {
+    return lhs.ticks == rhs.ticks && lhs.tie == rhs.tie;
+}
+
 struct OptimalRoute {
     double total_time = 0.0;
     std::vector<RouteItem> items;
@@ -20,22 +54,47 @@ struct OptimalRoute {
 
 class Transport_router {
 public:
-    Transport_router(const transport::core::TransportCatalogue& catalogue, const RoutingSettings& routing_settings)
+    using Graph = graph::DirectedWeightedGraph<RouteWeight>;
+
+    // Рёбра графа строятся в thread_count потоках (0 — по числу ядер); результат от него не зависит
+    Transport_router(const transport::core::TransportCatalogue& catalogue, const RoutingSettings& routing_settings,
+                     size_t thread_count = 1)
         : catalogue_(catalogue)
         , routing_settings_(routing_settings)
-        , graph_(InitGraph())
-        , router_(graph_)
+        , edge_offsets_(InitEdgeOffsets())
+        , graph_(InitGraph(thread_count))
+        , router_(graph_, routing_settings_.search_mode)
+    {
+    }
+    // Использует готовый граф, например загруженный из индекса маршрутизатора.
+    // items[edge_id] описывает ребро graph с этим id
+    Transport_router(const transport::core::TransportCatalogue& catalogue, const RoutingSettings& routing_settings,
+                     Graph graph, std::vector<RouteItem> items)
+        : catalogue_(catalogue)
+        , routing_settings_(routing_settings)
+        , items_(std::move(items))
+        , edge_offsets_(InitEdgeOffsets())
+        , graph_(CheckGraph(std::move(graph)))
+        , router_(graph_, routing_settings_.search_mode)
     {
     }
     std::optional<OptimalRoute> GetOptimalRoute(std::string_view from, std::string_view to) const;
+
+    const Graph& GetGraph() const;
+    const std::vector<RouteItem>& GetItems() const;
+    const graph::Router<RouteWeight>& GetRouter() const;
 private:
-    using Graph = graph::DirectedWeightedGraph<double>;
     const transport::core::TransportCatalogue& catalogue_;
     const RoutingSettings& routing_settings_; 
-    std::unordered_map<graph::EdgeId, RouteItem> id_of_Item_;
+    // Участок маршрута для каждого ребра графа (по EdgeId)
+    std::vector<RouteItem> items_;
+    // Первое ребро каждого автобуса в graph_: у автобуса из n остановок их n(n-1)/2
+    const std::vector<size_t> edge_offsets_;
     const Graph graph_;
-    const Graph InitGraph();
-    const graph::Router<double> router_;
-};
-
+    const graph::Router<RouteWeight> router_;
 
+    std::vector<size_t> InitEdgeOffsets() const;
+    const Graph InitGraph(size_t thread_count);
+    Graph CheckGraph(Graph graph) const;
+    double GetSegmentTime(const Route& bus, size_t stop) const;
+};